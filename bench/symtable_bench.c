@@ -0,0 +1,85 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   symtable_bench.c
+ *
+ * @brief  Microbenchmark of insertion into and lookup in a symtable.
+ *
+ *         Distinct keys are inserted into a new symtable and then looked up, for tables of
+ *         10, 1k and 100k symbols. Smaller tables are filled repeatedly, so every size
+ *         performs about a million operations. Build with "make bench", run bench/symtable_bench.
+ *
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "symtable.h"
+
+#define BENCH_OPS 1000000 // number of insertions (and lookups) measured for each size
+
+/**
+ * @brief       Returns monotonic time in seconds.
+ */
+static double now(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(){
+    int sizes[] = {10, 1000, 100000};
+
+    printf("symbols    insert (ns/op)    lookup (ns/op)\n");
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        int n    = sizes[s];
+        int reps = BENCH_OPS / n > 0 ? BENCH_OPS / n : 1;
+
+        char **keys = malloc(sizeof(char *) * n);
+        if(keys == NULL){
+            return 1;
+        }
+        for(int i = 0; i < n; i++){
+            keys[i] = malloc(16);
+            if(keys[i] == NULL){
+                return 1;
+            }
+            sprintf(keys[i], "var_%d", i * 7919);
+        }
+
+        symData       data   = {0};
+        double        insert = 0, lookup = 0;
+        volatile long found  = 0;
+        for(int r = 0; r < reps; r++){
+            symtable *tb = createSymtable();
+            double t0 = now();
+            for(int i = 0; i < n; i++){
+                insertSymNode(tb, keys[i], data);
+            }
+            double t1 = now();
+            for(int i = 0; i < n; i++){
+                found += findSymNode(tb, keys[i]) != NULL;
+            }
+            double t2 = now();
+            insert += t1 - t0;
+            lookup += t2 - t1;
+            deleteSymtable(tb);
+        }
+        if(found != (long)n * reps){
+            fprintf(stderr, "symtable_bench: %ld of %ld keys found\n", (long)found, (long)n * reps);
+            return 1;
+        }
+        printf("%-10d %-17.1f %.1f\n", n, insert * 1e9 / n / reps, lookup * 1e9 / n / reps);
+
+        for(int i = 0; i < n; i++){
+            free(keys[i]);
+        }
+        free(keys);
+    }
+    return 0;
+}
+
+/* EOF symtable_bench.c */
@@ -0,0 +1,343 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   ast_file_check.c
+ *
+ * @brief  Check that corrupted AST files are rejected by loadASTFile().
+ *
+ *         A valid file is written for a program using every type of node, then copies of it
+ *         are truncated and corrupted: magic, version, byte order, sizes of the arrays, the first
+ *         function, an unterminated string table and, in every node, references to other nodes,
+ *         frame slots, offsets of strings and offsets into extra. Every such file has to be
+ *         rejected, which makes the compiler print a diagnostic instead of generating code.
+ *         Then CHECK_RANDOM files with random bytes changed are loaded, and generated when
+ *         accepted; build with -fsanitize=address to catch reads out of the arrays.
+ *         Build and run with "make check".
+ *
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L // fmemopen, open_memstream, mkstemp
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include "ast_file.h"
+#include "code_generator.h"
+#include "parser.h"
+
+#define CHECK_RANDOM   3000 // number of randomly corrupted files
+#define CHECK_REPORTED 5    // number of printed accepted files
+
+static const char program[] =
+    "const ifj = @import(\"ifj24.zig\");\n"
+    "pub fn f(a: i32, b: ?i32) i32 {\n"
+    "    var k: i32 = a;\n"
+    "    if (b) |v| {\n"
+    "        k = k + v;\n"
+    "    } else {\n"
+    "        k = k - 1;\n"
+    "    }\n"
+    "    var n: ?i32 = k;\n"
+    "    while (n) |m| {\n"
+    "        k = k + m;\n"
+    "        n = null;\n"
+    "    }\n"
+    "    while (k < 10) {\n"
+    "        k = k + 2;\n"
+    "    }\n"
+    "    return k;\n"
+    "}\n"
+    "pub fn main() void {\n"
+    "    const s = ifj.string(\"text\");\n"
+    "    const x: f64 = 2.5;\n"
+    "    _ = ifj.length(s);\n"
+    "    const z: ?i32 = null;\n"
+    "    const r = f(3, z);\n"
+    "    ifj.write(r);\n"
+    "    ifj.write(x);\n"
+    "    return;\n"
+    "}\n";
+
+static char    path[] = "/tmp/ast_file_checkXXXXXX";
+static char   *valid;            // content of the valid file
+static size_t  validSize;
+static char   *data;             // content of the corrupted file
+static int     checked = 0, accepted = 0;
+static uint64_t state = 88172645463325252ULL;
+
+/**
+ * @brief       Returns next number of xorshift generator.
+ */
+static uint64_t next(){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**
+ * @brief       Compiles the program and stores its AST to the file.
+ *
+ * @return      true if the file was written, false otherwise.
+ */
+static bool writeValid(){
+    FILE *input = fmemopen((void *)program, sizeof(program) - 1, "r");
+    if(input == NULL){
+        return false;
+    }
+    set_input(input);
+    reset_scanner();
+    ASTree.root = parser(); // program is valid, errors end the check
+
+    compactAST tree;
+    buildCompactAST(&tree, ASTree.root);
+    bool ok = saveASTFile(&tree, path);
+    freeCompactAST(&tree);
+    delete_all_allocated();
+    set_input(NULL);
+    fclose(input);
+    return ok;
+}
+
+/**
+ * @brief       Writes the first size bytes of the corrupted content and loads the file.
+ *
+ * @param file  Pointer where the file is loaded.
+ *
+ * @return      true if the file was accepted, false if it was rejected.
+ */
+static bool load(astFile *file, size_t size){
+    FILE *out = fopen(path, "wb");
+    if(out == NULL || fwrite(data, 1, size, out) != size || fclose(out) != 0){
+        fprintf(stderr, "ast_file_check: cannot write %s\n", path);
+        exit(1);
+    }
+    return loadASTFile(file, path);
+}
+
+/**
+ * @brief       Checks that the corrupted content is rejected and restores the valid one.
+ *
+ * @param what  Description of the corruption.
+ * @param size  Number of bytes of the file.
+ */
+static void expectRejected(const char *what, size_t size){
+    astFile file;
+    checked++;
+    if(load(&file, size)){
+        unloadASTFile(&file);
+        if(accepted++ < CHECK_REPORTED){
+            printf("ast_file_check: file with %s was accepted\n", what);
+        }
+    }
+    memcpy(data, valid, validSize);
+}
+
+static char  *generated;    // code generated from an accepted file, not local variables,
+static size_t generatedLen; // as they are changed after setjmp()
+
+/**
+ * @brief       Generates code from a loaded tree, errors of the generator are recovered.
+ */
+static void generate(compactAST *tree){
+    FILE   *out = open_memstream(&generated, &generatedLen);
+    jmp_buf recovery;
+    if(out == NULL){
+        return;
+    }
+    if(setjmp(recovery) == 0){
+        errorRecovery = &recovery;
+        generate_code(tree, out);
+    }
+    errorRecovery = NULL;
+    fclose(out);
+    free(generated);
+    generated = NULL;
+}
+
+int main(){
+    setvbuf(stdout, NULL, _IOLBF, 0); // results are seen even if a corrupted file crashes the check
+    int fd = mkstemp(path);
+    if(fd < 0){
+        fprintf(stderr, "ast_file_check: cannot create a temporary file\n");
+        return 1;
+    }
+    close(fd);
+
+    FILE *in = NULL;
+    if(!writeValid() || (in = fopen(path, "rb")) == NULL){
+        fprintf(stderr, "ast_file_check: cannot write the valid file\n");
+        unlink(path);
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    validSize = ftell(in);
+    rewind(in);
+    valid = malloc(validSize);
+    data  = malloc(validSize);
+    if(valid == NULL || data == NULL || fread(valid, 1, validSize, in) != validSize){
+        fprintf(stderr, "ast_file_check: cannot read the valid file\n");
+        unlink(path);
+        return 1;
+    }
+    fclose(in);
+    memcpy(data, valid, validSize);
+
+    astFile file;
+    if(!load(&file, validSize)){
+        printf("ast_file_check: valid file was rejected\n");
+        unlink(path);
+        return 1;
+    }
+    unloadASTFile(&file);
+
+    // truncated files
+    for(size_t size = 0; size < validSize; size++){
+        expectRejected("truncated content", size);
+    }
+
+    // header
+    astFileHeader header;
+    memcpy(&header, valid, sizeof(header));
+    size_t extraOffset = sizeof(header) + header.nodeCnt * sizeof(compactNode);
+
+#define CORRUPT_HEADER(field, value, what) do { \
+        astFileHeader h = header; \
+        h.field = (value); \
+        memcpy(data, &h, sizeof(h)); \
+        expectRejected(what, validSize); \
+    } while(0)
+
+    data[0] ^= 1;
+    expectRejected("bad magic", validSize);
+    CORRUPT_HEADER(version, AST_FILE_VERSION + 1, "bad version");
+    CORRUPT_HEADER(byteOrder, 0x04030201, "bad byte order");
+    CORRUPT_HEADER(nodeCnt, header.nodeCnt - 1, "too few nodes");
+    CORRUPT_HEADER(extraCnt, header.extraCnt + 1, "too many extra items");
+    CORRUPT_HEADER(strtabLen, 0xFFFFFFFF, "huge string table");
+    CORRUPT_HEADER(first, header.nodeCnt, "first function out of the nodes");
+    CORRUPT_HEADER(first, 1, "first function which is not a definition");
+    data[validSize - 1] = 'x';
+    expectRejected("unterminated string table", validSize);
+
+    // nodes
+#define CORRUPT_NODE(field, value, what) do { \
+        compactNode n = node; \
+        n.field = (value); \
+        memcpy(data + offset, &n, sizeof(n)); \
+        expectRejected(what, validSize); \
+    } while(0)
+
+    for(astIdx i = 0; i < header.nodeCnt; i++){
+        size_t      offset = sizeof(header) + i * sizeof(compactNode);
+        compactNode node;
+        memcpy(&node, valid + offset, sizeof(node));
+
+        CORRUPT_NODE(type, 0xFF, "unknown type of node");
+        CORRUPT_NODE(next, header.nodeCnt, "next node out of the nodes");
+        if(node.type != AST_NODE_DEFFUNC){
+            CORRUPT_NODE(next, i, "node following itself");
+        }
+        switch(node.type){
+            case AST_NODE_BINOP:
+                CORRUPT_NODE(b, header.nodeCnt, "right operand out of the nodes");
+                CORRUPT_NODE(b, i, "operand referencing its operation");
+                // fall through
+            case AST_NODE_EXPR:
+            case AST_UNUSED:
+            case AST_NODE_RETURN:
+                if(node.a == AST_NONE){
+                    break; // return without expression
+                }
+                // fall through
+            case AST_NODE_DEFFUNC:
+                CORRUPT_NODE(a, header.nodeCnt, "child out of the nodes");
+                CORRUPT_NODE(a, i, "node referencing itself");
+                if(node.type == AST_NODE_DEFFUNC){
+                    CORRUPT_NODE(b, header.extraCnt, "definition without extra items");
+                }
+                break;
+            case AST_NODE_WHILE:
+            case AST_NODE_IFELSE:
+                CORRUPT_NODE(a, header.nodeCnt, "condition out of the nodes");
+                CORRUPT_NODE(a, i, "condition referencing its statement");
+                CORRUPT_NODE(b, header.extraCnt, "statement without extra items");
+                break;
+            case AST_NODE_ASSIGN:
+            case AST_NODE_DEFVAR:
+                CORRUPT_NODE(a, header.nodeCnt, "expression out of the nodes");
+                CORRUPT_NODE(b, 1000000, "frame slot out of the frame");
+                break;
+            case AST_NODE_VAR:
+                CORRUPT_NODE(a, 1000000, "frame slot out of the frame");
+                break;
+            case AST_NODE_LITERAL:
+                if(node.dataT == u8 || node.dataT == string){
+                    CORRUPT_NODE(a, header.strtabLen, "string out of the string table");
+                }
+                break;
+            case AST_NODE_FUNC_CALL:
+                CORRUPT_NODE(a, header.strtabLen, "name out of the string table");
+                CORRUPT_NODE(b, header.extraCnt, "call without extra items");
+                break;
+            default:
+                break;
+        }
+    }
+
+    // extra items of definitions of functions: name, number of parameters, frame size
+    for(astIdx i = 0; i < header.nodeCnt; i++){
+        compactNode node;
+        memcpy(&node, valid + sizeof(header) + i * sizeof(compactNode), sizeof(node));
+        if(node.type != AST_NODE_DEFFUNC){
+            continue;
+        }
+        size_t item = extraOffset + node.b * sizeof(astIdx);
+        astIdx values[3] = {header.strtabLen, 1000000, 1000000};
+        const char *what[3] = {"name of function out of the string table", "more parameters than slots",
+                               "frame out of extra items"};
+        for(int k = 0; k < 3; k++){
+            memcpy(data + item + k * sizeof(astIdx), &values[k], sizeof(astIdx));
+            expectRejected(what[k], validSize);
+        }
+    }
+
+    int rejected = checked - accepted;
+    printf("ast_file_check: %d of %d corrupted files rejected\n", rejected, checked);
+    if(accepted != 0){ // generating accepted files would read out of the arrays
+        unlink(path);
+        return 1;
+    }
+
+    // random corruption, files which are accepted have to be generated without errors in memory
+    FILE *diag = fopen("/dev/null", "w");
+    errorOutput = diag;
+    int loaded = 0;
+    for(int i = 0; i < CHECK_RANDOM; i++){
+        for(int k = 1 + next() % 4; k > 0; k--){
+            size_t pos = sizeof(header) + next() % (validSize - sizeof(header));
+            data[pos] ^= (char)(1 << next() % 8);
+        }
+        if(load(&file, validSize)){
+            generate(&file.tree);
+            unloadASTFile(&file);
+            loaded++;
+        }
+        memcpy(data, valid, validSize);
+    }
+    errorOutput = NULL;
+    if(diag != NULL){
+        fclose(diag);
+    }
+    printf("ast_file_check: %d randomly corrupted files, %d accepted and generated\n", CHECK_RANDOM, loaded);
+
+    unlink(path);
+    free(valid);
+    free(data);
+    return accepted != 0;
+}
+
+/* EOF ast_file_check.c */
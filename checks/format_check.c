@@ -0,0 +1,120 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   format_check.c
+ *
+ * @brief  Randomized check of formatting of literals against sprintf.
+ *
+ *         buf_format_int() has to print the same text as "%d" and buf_format_float() the same
+ *         text as "%a" for every value. Edge cases are checked first, then CHECK_VALUES random
+ *         values of each type, with the bits of floats biased towards subnormals, short
+ *         mantissas, infinities and NaNs. Build and run with "make check".
+ *
+ * @date   19.10.2026
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "code_buffer.h"
+
+#define CHECK_VALUES   20000000 // number of random values checked for each type
+#define CHECK_REPORTED 5        // number of printed mismatches
+
+static uint64_t state = 88172645463325252ULL;
+static long     checked = 0, mismatched = 0;
+
+/**
+ * @brief       Returns next number of xorshift generator, its seed is the first argument of the check.
+ */
+static uint64_t next(){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**
+ * @brief       Compares the formatted text with the expected one and reports a mismatch.
+ *
+ * @param got      Text printed by the compiler, not terminated.
+ * @param len      Length of the text printed by the compiler.
+ * @param expected Text printed by sprintf.
+ */
+static void compare(char *got, size_t len, const char *expected){
+    got[len] = '\0';
+    checked++;
+    if(strcmp(got, expected) != 0 && mismatched++ < CHECK_REPORTED){
+        printf("format_check: got %s, expected %s\n", got, expected);
+    }
+}
+
+/**
+ * @brief       Checks formatting of an integer literal.
+ */
+static void checkInt(int num){
+    char got[64], expected[64];
+    sprintf(expected, "%d", num);
+    compare(got, buf_format_int(got, num), expected);
+}
+
+/**
+ * @brief       Checks formatting of a float literal.
+ */
+static void checkFloat(double num){
+    char got[64], expected[64];
+    sprintf(expected, "%a", num);
+    compare(got, buf_format_float(got, num), expected);
+}
+
+int main(int argc, char **argv){
+    if(argc > 1){
+        state = strtoull(argv[1], NULL, 10) | 1; // generator must not start from zero
+    }
+
+    int ints[] = {0, 1, -1, 9, 10, -10, 99, 100, INT_MAX, INT_MIN, INT_MIN + 1, 123456789};
+    for(size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++){
+        checkInt(ints[i]);
+    }
+    for(long i = 0; i < CHECK_VALUES; i++){
+        int num = (int)next();
+        if(i & 1){ // short numbers as well
+            num >>= next() % 31;
+        }
+        checkInt(num);
+    }
+
+    double floats[] = {0.0, -0.0, 1.0, -1.0, 0.5, 2.0, INFINITY, -INFINITY, NAN, -NAN, 5e-324, -5e-324,
+                       2.2250738585072014e-308, 2.2250738585072009e-308, 1.7976931348623157e308, 0.1, 3.14};
+    for(size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++){
+        checkFloat(floats[i]);
+    }
+    for(long i = 0; i < CHECK_VALUES; i++){
+        uint64_t bits = next();
+        switch(i % 4){
+            case 1: // subnormal
+                bits &= ~(0x7ffULL << 52);
+                break;
+            case 2: // few digits of mantissa
+                bits &= 0xfff0000000000000ULL | (next() & 0xff00000000000ULL);
+                break;
+            case 3: // NaN, or infinity
+                bits |= 0x7ffULL << 52;
+                if(i % 8 == 3){
+                    bits &= 0xfff0000000000000ULL;
+                }
+                break;
+        }
+        double num;
+        memcpy(&num, &bits, sizeof(num));
+        checkFloat(num);
+    }
+
+    printf("format_check: %ld values checked, %ld mismatched\n", checked, mismatched);
+    return mismatched != 0;
+}
+
+/* EOF format_check.c */
@@ -0,0 +1,244 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   incremental_check.c
+ *
+ * @brief  Check of incremental compilation against fresh compilations.
+ *
+ *         One incrState compiles a sequence of edits of a program: changed bodies with the same
+ *         and with a different number of labels, errors in the program, a changed signature,
+ *         added and removed functions. Every result has to have the exit code and the code
+ *         of ifj24CompileStream() compiling the same version from scratch, and functions which
+ *         did not change have to be taken over. Build and run with "make check".
+ *
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L // fmemopen, open_memstream
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "ifj24.h"
+#include "incremental.h"
+
+#define HEADER "const ifj = @import(\"ifj24.zig\");\n"
+
+// loop with a condition, labels of the following functions depend on it
+#define F0 \
+    "pub fn f(a: i32, b: i32) i32 {\n" \
+    "    var k: i32 = 0;\n" \
+    "    var acc: i32 = a;\n" \
+    "    while (k < b) {\n" \
+    "        if (k == 1) {\n" \
+    "            acc = acc + k;\n" \
+    "        } else {\n" \
+    "            acc = acc - 1;\n" \
+    "        }\n" \
+    "        k = k + 1;\n" \
+    "    }\n" \
+    "    return acc;\n" \
+    "}\n"
+
+// one more loop, so the function has more labels
+#define F1 \
+    "pub fn f(a: i32, b: i32) i32 {\n" \
+    "    var k: i32 = 0;\n" \
+    "    var acc: i32 = a;\n" \
+    "    while (k < b) {\n" \
+    "        if (k == 1) {\n" \
+    "            acc = acc + k;\n" \
+    "        } else {\n" \
+    "            acc = acc - 1;\n" \
+    "        }\n" \
+    "        k = k + 1;\n" \
+    "    }\n" \
+    "    while (acc < 0) {\n" \
+    "        acc = acc + 2;\n" \
+    "    }\n" \
+    "    return acc;\n" \
+    "}\n"
+
+// changed type of a parameter
+#define F2 \
+    "pub fn f(a: f64, b: i32) i32 {\n" \
+    "    var k: i32 = 0;\n" \
+    "    var acc: i32 = ifj.f2i(a);\n" \
+    "    while (k < b) {\n" \
+    "        acc = acc + k;\n" \
+    "        k = k + 1;\n" \
+    "    }\n" \
+    "    return acc;\n" \
+    "}\n"
+
+#define G0 \
+    "pub fn g(x: i32) i32 {\n" \
+    "    const r = f(x, 3);\n" \
+    "    return r;\n" \
+    "}\n"
+
+#define G2 \
+    "pub fn g(x: i32) i32 {\n" \
+    "    const r = f(ifj.i2f(x), 3);\n" \
+    "    return r;\n" \
+    "}\n"
+
+#define H0 \
+    "pub fn h(s: []u8) i32 {\n" \
+    "    const t = ifj.concat(s, s);\n" \
+    "    const n = ifj.length(t);\n" \
+    "    if (n > 3) {\n" \
+    "        ifj.write(t);\n" \
+    "    } else {\n" \
+    "    }\n" \
+    "    return n;\n" \
+    "}\n"
+
+// changed body with the same labels
+#define H1 \
+    "pub fn h(s: []u8) i32 {\n" \
+    "    const t = ifj.concat(s, ifj.string(\"c\"));\n" \
+    "    const n = ifj.length(t);\n" \
+    "    if (n > 3) {\n" \
+    "        ifj.write(t);\n" \
+    "    } else {\n" \
+    "    }\n" \
+    "    return n;\n" \
+    "}\n"
+
+#define H_SYNTAX \
+    "pub fn h(s: []u8) i32 {\n" \
+    "    const t = ifj.concat(s, ;\n" \
+    "    const n = ifj.length(t);\n" \
+    "    return n;\n" \
+    "}\n"
+
+#define H_TYPE \
+    "pub fn h(s: []u8) i32 {\n" \
+    "    const t = ifj.concat(s, s);\n" \
+    "    const n: i32 = ifj.length(t) + s;\n" \
+    "    return n;\n" \
+    "}\n"
+
+#define E0 \
+    "pub fn e() void {\n" \
+    "    ifj.write(7);\n" \
+    "}\n"
+
+#define M0 \
+    "pub fn main() void {\n" \
+    "    const v = g(5);\n" \
+    "    ifj.write(v);\n" \
+    "    const s = ifj.string(\"ab\");\n" \
+    "    const n = h(s);\n" \
+    "    ifj.write(n);\n" \
+    "}\n"
+
+#define M1 \
+    "pub fn main() void {\n" \
+    "    const v = g(5);\n" \
+    "    ifj.write(v);\n" \
+    "    e();\n" \
+    "    const s = ifj.string(\"ab\");\n" \
+    "    const n = h(s);\n" \
+    "    ifj.write(n);\n" \
+    "}\n"
+
+typedef struct checkStep{
+    const char *name;
+    const char *source;
+    int         checked;   // functions which have to be checked again, -1 for a failed compilation
+    int         reused;    // functions whose code has to be taken from the last compilation
+}checkStep;
+
+// f is defined first, so when its labels change, code of the other functions is generated again
+static const checkStep steps[] = {
+    {"initial program",              HEADER F0 G0 H0 M0,        4,  0},
+    {"body with the same labels",    HEADER F0 G0 H1 M0,        1,  3},
+    {"body with more labels",        HEADER F1 G0 H1 M0,        1,  0},
+    {"syntax error",                 HEADER F1 G0 H_SYNTAX M0, -1, -1},
+    {"syntax error fixed",           HEADER F1 G0 H1 M0,        0,  4},
+    {"signature of called function", HEADER F2 G0 H1 M0,       -1, -1},
+    {"caller of changed function",   HEADER F2 G2 H1 M0,        2,  0},
+    {"type error",                   HEADER F2 G2 H_TYPE M0,   -1, -1},
+    {"added function",               HEADER F2 G2 H0 E0 M1,     5,  0},
+    {"removed function",             HEADER F2 G2 H0 M0,        4,  0},
+    {"initial program again",        HEADER F0 G0 H0 M0,        2,  0},
+    {"same program again",           HEADER F0 G0 H0 M0,        0,  4},
+};
+
+/**
+ * @brief       Compiles a program, either incrementally or from scratch.
+ *
+ * @param st     State of incremental compilation, NULL for ifj24CompileStream().
+ * @param source Program.
+ * @param code   Pointer where the generated code is stored, it has to be freed.
+ *
+ * @return      Exit code of the compilation, -1 if the streams cannot be opened.
+ */
+static int compileVersion(incrState *st, const char *source, char **code){
+    char  *diag = NULL;
+    size_t codeLen = 0, diagLen = 0;
+    FILE  *input = fmemopen((void *)source, strlen(source), "r");
+    FILE  *out   = open_memstream(code, &codeLen);
+    FILE  *err   = open_memstream(&diag, &diagLen);
+
+    int ret = -1;
+    if(input != NULL && out != NULL && err != NULL){
+        if(st != NULL){
+            errorOutput = err; // diagnostics are compared by exit codes only
+            ret = incrCompile(st, input, out);
+            errorOutput = NULL;
+        }
+        else{
+            ret = ifj24CompileStream(input, out, err);
+        }
+    }
+    if(input != NULL) fclose(input);
+    if(out != NULL) fclose(out);
+    if(err != NULL) fclose(err);
+    free(diag);
+    return ret;
+}
+
+int main(){
+    incrState st;
+    incrInit(&st);
+
+    int failed = 0;
+    for(size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++){
+        char *incrCode = NULL, *freshCode = NULL;
+        int   incrRet  = compileVersion(&st, steps[i].source, &incrCode);
+        int   freshRet = compileVersion(NULL, steps[i].source, &freshCode);
+
+        const char *problem = NULL;
+        if(incrRet != freshRet){
+            problem = "exit code differs";
+        }
+        else if((incrRet == 0) != (steps[i].checked >= 0)){
+            problem = "unexpected exit code";
+        }
+        else if(incrRet == 0 && strcmp(incrCode, freshCode) != 0){
+            problem = "code differs";
+        }
+        else if(incrRet == 0 && (st.checked != steps[i].checked || st.reused != steps[i].reused)){
+            problem = "unexpected functions checked or reused";
+        }
+        printf("incremental_check: %-30s exit %d, %d checked, %d generated, %d reused%s%s\n", steps[i].name,
+               incrRet, incrRet == 0 ? st.checked : 0, incrRet == 0 ? st.generated : 0, incrRet == 0 ? st.reused : 0,
+               problem != NULL ? ": " : "", problem != NULL ? problem : "");
+        if(problem != NULL){
+            printf("incremental_check: fresh compilation exited with %d\n", freshRet);
+            failed++;
+        }
+        free(incrCode);
+        free(freshCode);
+    }
+
+    incrFree(&st);
+    printf("incremental_check: %d of %d steps failed\n", failed, (int)(sizeof(steps) / sizeof(steps[0])));
+    return failed != 0;
+}
+
+/* EOF incremental_check.c */
@@ -0,0 +1,90 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   arena.c
+ * 
+ * @brief  Implementation of region (arena) allocator.
+ * 
+ *         Memory is taken from the current block by moving a pointer. When the block is full,
+ *         a new one is allocated and linked in front of the old ones. Nothing is freed separately,
+ *         arenaRelease() frees all blocks in time proportional to the number of blocks.
+ * 
+ * @date   19.10.2026
+*/
+
+#include "arena.h"
+#include "error.h"
+#include "parser.h"
+
+#define ARENA_ALIGN sizeof(double) // alignment of every returned pointer
+
+THREAD_LOCAL arena compileArena = {.head = NULL};
+
+/**
+ * @brief      Allocates memory from the arena.
+ * 
+ * @param ar   Pointer to the arena.
+ * @param size Number of bytes to allocate.
+ * 
+ * @return     Pointer to the allocated memory, valid until arenaRelease() is called.
+ */
+void *arenaAlloc(arena *ar, size_t size){
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    arenaBlock *block = ar->head;
+    if(block == NULL || block->size - block->used < size){
+        size_t blockSize = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+        block = malloc(sizeof(arenaBlock) + blockSize);
+        if(block == NULL){
+            ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
+        }
+        block->size = blockSize;
+        block->used = 0;
+
+        if(ar->head != NULL && size > ARENA_BLOCK_SIZE){ // keep allocating from the current block
+            block->next    = ar->head->next;
+            ar->head->next = block;
+        }
+        else{
+            block->next = ar->head;
+            ar->head    = block;
+        }
+    }
+
+    void *mem    = block->data + block->used;
+    block->used += size;
+    return mem;
+}
+
+/**
+ * @brief    Frees all memory allocated from the arena.
+ * 
+ * @param ar Pointer to the arena.
+ */
+void arenaRelease(arena *ar){
+    while(ar->head != NULL){
+        arenaBlock *next = ar->head->next;
+        free(ar->head);
+        ar->head = next;
+    }
+}
+
+/**
+ * @brief    Frees all memory allocated from the arena, but keeps one block for next allocations.
+ * 
+ * @param ar Pointer to the arena.
+ */
+void arenaReset(arena *ar){
+    arenaBlock *keep = ar->head;
+    if(keep == NULL){
+        return;
+    }
+    ar->head = keep->next;
+    arenaRelease(ar);
+
+    keep->next = NULL;
+    keep->used = 0;
+    ar->head   = keep;
+}
+
+/* EOF arena.c */
@@ -0,0 +1,43 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   arena.h
+ * 
+ * @brief  Header file for region (arena) allocator.
+ * 
+ *         Arena hands out memory from big blocks and frees all of it at once, so data living
+ *         until the end of compilation (AST, scopes, function data) need no deallocation one by one.
+ * 
+ * @date   19.10.2026
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdlib.h>
+#include "thread_local.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024) // bigger requests get a block of their own
+
+typedef struct arenaBlock{
+    struct arenaBlock *next;
+    size_t             size; // usable bytes in data
+    size_t             used;
+    char               data[];
+}arenaBlock;
+
+typedef struct arena{
+    arenaBlock *head; // block currently allocated from, older blocks follow
+}arena;
+
+/* global arena for everything allocated for the whole compilation,
+   released in delete_all_allocated() */
+extern THREAD_LOCAL arena compileArena;
+
+void *arenaAlloc  (arena *ar, size_t size);
+void  arenaRelease(arena *ar);
+void  arenaReset  (arena *ar);
+
+#endif //ARENA_H
+
+/* EOF arena.h */
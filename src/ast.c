@@ -18,6 +18,7 @@
 
 
 #include "ast.h"
+#include "arena.h"
 #include "error.h"
 #include "parser.h"
 
@@ -29,14 +30,12 @@
  *          is allocated so expression parser can connect built nodes to it.
  * 
  * @warning Always call specific create*Node() on returned invalid node.
+ *          Node is allocated in compileArena, it must not be freed separately.
  * 
  * @return  Created astNode.
  */
 astNode *createAstNode(){
-    astNode *new = malloc(sizeof(astNode));
-    if(new == NULL){ 
-        ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
-    }
+    astNode *new = arenaAlloc(&compileArena, sizeof(astNode));
 
     new->next   = NULL;
     new->type   = AST_INVALID;
@@ -54,17 +53,19 @@ astNode *createAstNode(){
  * @param dest      Pointer to the astNode to initialize as a WHILE node.
  * @param withNull  Flag indicating if the condition is withNull.
  * @param id_without_null ID of the constant without null.
+ * @param slotWithoutNull Frame slot of the constant without null, -1 if not present.
  * @param cond      astNode of condition expression (usually astExpr).
  * @param body      astNode of body of while (root)
  * @param symtableW Pointer to the symtable of while.
  */
-void createWhileNode(astNode *dest, bool withNull, char *id_without_null, astNode *cond, astNode *body, symtable *symtableW){
+void createWhileNode(astNode *dest, bool withNull, char *id_without_null, int slotWithoutNull, astNode *cond, astNode *body, symtable *symtableW){
 
     astWhile newWhile = {
         .body = body,
         .condition = cond,
         .withNull = withNull,
         .id_without_null = id_without_null,
+        .slotWithoutNull = slotWithoutNull,
         .symtableWhile = symtableW
     };
 
@@ -107,14 +108,16 @@ void createIfElseNode(astNode *dest, astNode *cond, astNode *ifPart, astNode *el
  * 
  * @param dest            Pointer to the astNode to initialize as an IF node.
  * @param id_without_null ID of the constant without null.
+ * @param slotWithoutNull Frame slot of the constant without null, -1 if not present.
  * @param symtable        Pointer to the symtable of the if statement.
  * @param body            astNode of the body of the if statement (root).
  */
 
-void createIfNode(astNode *dest, char *id_without_null, symtable *symtable, astNode *body){
+void createIfNode(astNode *dest, char *id_without_null, int slotWithoutNull, symtable *symtable, astNode *body){
     astIf newIf = {
         .body = body,
         .id_without_null = id_without_null,
+        .slotWithoutNull = slotWithoutNull,
         .symtableIf = symtable
     };
 
@@ -152,12 +155,14 @@ void createElseNode(astNode *dest, symtable *symtableElse, astNode *body) {
  * 
  * @param dest        Pointer to the astNode to initialize as an ASSIGN node.
  * @param id          Identifier of the variable being assigned.
+ * @param slot        Frame slot of the variable being assigned.
  * @param expression  astNode representing the expression to be assigned.
  * @param dataT       The data type of the assignment.
  */
-void createAssignNode(astNode *dest, char *id, astNode *expression, dataType dataT) {
+void createAssignNode(astNode *dest, char *id, int slot, astNode *expression, dataType dataT) {
     astAssign newAssign = {
         .id = id,
+        .slot = slot,
         .expression = expression,
         .dataT = dataT
     };
@@ -181,6 +186,7 @@ void createAssignNode(astNode *dest, char *id, astNode *expression, dataType dat
 void createDefVarNode(astNode *dest, char *id, astNode *initExpr, symNode *symtableEntry) {
     astDefVar newDefVar = {
         .id = id,
+        .slot = symtableEntry->data.data.vData.slot,
         .initExpr = initExpr,
         .symtableEntry = symtableEntry
     };
@@ -202,16 +208,18 @@ void createDefVarNode(astNode *dest, char *id, astNode *initExpr, symNode *symta
  * @param body          astNode of the body of the function (root).
  * @param paramNames    Array of parameter names for the function.
  * @param paramNum      Number of parameters for the function.
+ * @param frameSize     Number of variable slots in the frame of the function.
  * @param returnType    The return type of the function.
  * @param nullable      Whether the function return type can be nullable.
  */
-void createDefFuncNode(astNode *dest, char *id, symtable *symtableFun, astNode *body, char **paramNames, int paramNum, dataType returnType, bool nullable) {
+void createDefFuncNode(astNode *dest, char *id, symtable *symtableFun, astNode *body, char **paramNames, int paramNum, int frameSize, dataType returnType, bool nullable) {
     astDefFunc newDefFunc = {
         .id          = id,
         .symtableFun = symtableFun,
         .body        = body,
         .paramNames  = paramNames,
         .paramNum    = paramNum,
+        .frameSize   = frameSize,
         .returnType  = returnType,
         .nullable    = nullable
     };
@@ -262,7 +270,8 @@ void createBinOpNode(astNode *dest, symbol_number op, astNode *left, astNode *ri
         .op = op,
         .left = left,
         .right = right,
-        .dataT = dataT
+        .dataT = dataT,
+        .retypeTo = unknown
     };
 
    
@@ -283,7 +292,8 @@ void createBinOpNode(astNode *dest, symbol_number op, astNode *left, astNode *ri
  */
 void createLiteralNode(astNode *dest, dataType dataT, void *value) {
     astLiteral newLiteral = {
-        .dataT = dataT
+        .dataT = dataT,
+        .retypeTo = unknown
     };
 
     if (dataT == i32) {
@@ -318,6 +328,7 @@ void createVarNode(astNode *dest, char *id, dataType dataT, symNode *symtableEnt
     astVar newVar = {
         .dataT = dataT,
         .id = id,
+        .slot = symtableEntry->data.data.vData.slot,
         .symtableEntry = symtableEntry,
         .isNullable = symtableEntry->data.data.vData.isNullable
     };
@@ -342,7 +353,7 @@ void createVarNode(astNode *dest, char *id, dataType dataT, symNode *symtableEnt
  * @param paramNum      Number of parameters.
  * @param isNullable    Whether the return type is nullable.
  */
-void createFuncCallNode(astNode *dest, char *id, dataType retType, bool builtin, symNode *symtableEntry, astNode **paramExpr, int paramNum, bool isNullable) {
+void createFuncCallNode(astNode *dest, char *id, dataType retType, bool builtin, const symNode *symtableEntry, astNode **paramExpr, int paramNum, bool isNullable) {
     astFuncCall newFuncCall = {
         .retType         = retType,
         .nullableRetType = isNullable,
@@ -355,7 +366,6 @@ void createFuncCallNode(astNode *dest, char *id, dataType retType, bool builtin,
     dest->next = NULL;
     dest->type = AST_NODE_FUNC_CALL;
     dest->nodeRep.funcCallNode = newFuncCall;
-    symtableEntry->data.used = true; // set for semantic check
 }
 
 /**
@@ -440,73 +450,350 @@ void connectToBlock(astNode *toAdd, astNode *blockRoot){
 
 }
 
+/************************************************************************************************************** 
+                                         SECTION Compact AST
+                 Lowering of AST to compact, index-based representation consumed by code generator.
+*************************************************************************************************************/
+
+#define COMPACT_INIT_CAPACITY 64
+
+/**
+ * @brief       Grows the array when there is no space for cnt more elements.
+ * 
+ * @param array Pointer to the array.
+ * @param cap   Pointer to the capacity of the array in elements.
+ * @param used  Number of used elements.
+ * @param cnt   Number of elements to add.
+ * @param size  Size of one element.
+ */
+static void compactReserve(void **array, astIdx *cap, astIdx used, astIdx cnt, size_t size){
+    if(used + cnt <= *cap){
+        return;
+    }
+    astIdx newCap = (*cap == 0) ? COMPACT_INIT_CAPACITY : *cap;
+    while(newCap < used + cnt){
+        newCap *= 2;
+    }
+    void *tmp = realloc(*array, newCap * size);
+    if(tmp == NULL){
+        ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
+    }
+    *array = tmp;
+    *cap   = newCap;
+}
+
+/**
+ * @brief      Appends a new node to the compact AST.
+ * 
+ * @param tree Pointer to the compact AST.
+ * @param type Type of the node.
+ * 
+ * @return     Index of the new node, all its links are AST_NONE.
+ */
+astIdx compactAddNode(compactAST *tree, astNodeType type){
+    compactReserve((void **)&tree->nodes, &tree->nodeCap, tree->nodeCnt, 1, sizeof(compactNode));
+    compactNode newNode = {.type = type, .dataT = unknown, .next = AST_NONE, .a = AST_NONE, .b = AST_NONE};
+    tree->nodes[tree->nodeCnt] = newNode;
+    return tree->nodeCnt++;
+}
+
+/**
+ * @brief      Reserves space for payload of a node in array extra.
+ * 
+ * @param tree Pointer to the compact AST.
+ * @param cnt  Number of elements to reserve.
+ * 
+ * @return     Index of the first reserved element.
+ */
+astIdx compactAddExtra(compactAST *tree, int cnt){
+    compactReserve((void **)&tree->extra, &tree->extraCap, tree->extraCnt, cnt, sizeof(astIdx));
+    astIdx first    = tree->extraCnt;
+    tree->extraCnt += cnt;
+    return first;
+}
+
 /**
- * @brief      Recursively frees nodes in AST.
+ * @brief      Copies the string to the string table.
  * 
- * @param node Node to free and recursively free its children.
+ * @param tree Pointer to the compact AST.
+ * @param str  String to copy, NULL is allowed.
+ * 
+ * @return     Offset of the string in the string table, AST_NONE for NULL.
  */
-void freeASTNode(astNode *node){
-    if(node == NULL){return;}
+astIdx compactAddString(compactAST *tree, char *str){
+    if(str == NULL){
+        return AST_NONE;
+    }
+    astIdx len = strlen(str) + 1;
+    compactReserve((void **)&tree->strtab, &tree->strtabCap, tree->strtabLen, len, sizeof(char));
+    memcpy(tree->strtab + tree->strtabLen, str, len);
+    astIdx offset    = tree->strtabLen;
+    tree->strtabLen += len;
+    return offset;
+}
+
+/**
+ * @brief        Returns string stored in the string table.
+ * 
+ * @param tree   Pointer to the compact AST.
+ * @param offset Offset of the string.
+ * 
+ * @return       Pointer to the string, NULL for AST_NONE.
+ */
+char *compactString(compactAST *tree, astIdx offset){
+    return (offset == AST_NONE) ? NULL : tree->strtab + offset;
+}
+
+/**
+ * @brief       Lowers a block of statements (chain of nodes connected by next).
+ * 
+ * @param tree  Pointer to the compact AST.
+ * @param node  First node of the block, root node of the block is skipped.
+ * @param names Names of frame slots of the current function to fill.
+ * 
+ * @return      Index of the first statement, AST_NONE for empty block.
+ */
+astIdx compactChain(compactAST *tree, astNode *node, astIdx *names){
+    if(node != NULL && node->type == AST_NODE_ROOT){
+        node = node->next;
+    }
+
+    astIdx first = AST_NONE;
+    astIdx prev  = AST_NONE;
+    for(; node != NULL; node = node->next){
+        astIdx idx = compactSubtree(tree, node, names);
+        if(prev == AST_NONE){
+            first = idx;
+        }
+        else{
+            tree->nodes[prev].next = idx;
+        }
+        prev = idx;
+    }
+    return first;
+}
+
+/**
+ * @brief       Lowers one node with its children, next node is not followed.
+ * 
+ * @param tree  Pointer to the compact AST.
+ * @param node  Node to lower.
+ * @param names Names of frame slots of the current function to fill.
+ * 
+ * @return      Index of the lowered node, AST_NONE for NULL.
+ */
+astIdx compactSubtree(compactAST *tree, astNode *node, astIdx *names){
+    if(node == NULL){
+        return AST_NONE;
+    }
+
+    astIdx idx = compactAddNode(tree, node->type);
+    astIdx a   = AST_NONE;
+    astIdx b   = AST_NONE;
+    uint8_t dataT = unknown;
+    uint8_t flags = 0;
+    uint8_t op    = 0;
+
     switch(node->type){
-        case AST_NODE_WHILE:
-            freeASTNode(node->nodeRep.whileNode.condition);
-            freeASTNode(node->nodeRep.whileNode.body);
-            deleteSymtable(node->nodeRep.whileNode.symtableWhile);
-            break;
-        case AST_NODE_IFELSE:
-            freeASTNode(node->nodeRep.ifElseNode.condition);
-            freeASTNode(node->nodeRep.ifElseNode.ifPart);
-            freeASTNode(node->nodeRep.ifElseNode.elsePart);
-            break;
-        case AST_NODE_IF:
-            deleteSymtable(node->nodeRep.ifNode.symtableIf);
-            freeASTNode(node->nodeRep.ifNode.body);
-            break;
-        case AST_NODE_ELSE:
-            deleteSymtable(node->nodeRep.elseNode.symtableElse);
-            freeASTNode(node->nodeRep.elseNode.body);
-            break;
+        case AST_NODE_WHILE: {
+            astWhile *w = &node->nodeRep.whileNode;
+            if(w->withNull){
+                flags |= COMPACT_WITH_NULL;
+                names[w->slotWithoutNull] = compactAddString(tree, w->id_without_null);
+            }
+            a = compactSubtree(tree, w->condition, names);
+            astIdx body = compactChain(tree, w->body, names);
+            b = compactAddExtra(tree, 3);
+            tree->extra[b]     = body;
+            tree->extra[b + 1] = (astIdx)w->slotWithoutNull;
+            tree->extra[b + 2] = w->withNull ? names[w->slotWithoutNull] : AST_NONE;
+            break;
+        }
+        case AST_NODE_IFELSE: {
+            astIfElse *ie = &node->nodeRep.ifElseNode;
+            astIf     *ip = &ie->ifPart->nodeRep.ifNode;
+            if(ie->withNull){
+                flags |= COMPACT_WITH_NULL;
+                names[ip->slotWithoutNull] = compactAddString(tree, ip->id_without_null);
+            }
+            a = compactSubtree(tree, ie->condition, names);
+            astIdx ifBody   = compactChain(tree, ip->body, names);
+            astIdx elseBody = compactChain(tree, ie->elsePart->nodeRep.elseNode.body, names);
+            b = compactAddExtra(tree, 4);
+            tree->extra[b]     = ifBody;
+            tree->extra[b + 1] = elseBody;
+            tree->extra[b + 2] = (astIdx)ip->slotWithoutNull;
+            tree->extra[b + 3] = ie->withNull ? names[ip->slotWithoutNull] : AST_NONE;
+            break;
+        }
         case AST_NODE_ASSIGN:
-            freeASTNode(node->nodeRep.assignNode.expression);
-            break;
-        case AST_NODE_DEFFUNC:
-            freeASTNode(node->nodeRep.defFuncNode.body);
-            deleteSymtable(node->nodeRep.defFuncNode.symtableFun);
-            break;
-        case AST_NODE_RETURN:
-            freeASTNode(node->nodeRep.returnNode.returnExp);
+            names[node->nodeRep.assignNode.slot] = compactAddString(tree, node->nodeRep.assignNode.id);
+            a = compactSubtree(tree, node->nodeRep.assignNode.expression, names);
+            b = (astIdx)node->nodeRep.assignNode.slot;
+            dataT = node->nodeRep.assignNode.dataT;
             break;
         case AST_NODE_EXPR:
-            freeASTNode(node->nodeRep.exprNode.exprTree);
+            a = compactSubtree(tree, node->nodeRep.exprNode.exprTree, names);
+            dataT = node->nodeRep.exprNode.dataT;
             break;
         case AST_NODE_BINOP:
-            freeASTNode(node->nodeRep.binOpNode.left);
-            freeASTNode(node->nodeRep.binOpNode.right);
-            break;
-        case AST_NODE_DEFVAR:
-            freeASTNode(node->nodeRep.defVarNode.initExpr);
+            a = compactSubtree(tree, node->nodeRep.binOpNode.left, names);
+            b = compactSubtree(tree, node->nodeRep.binOpNode.right, names);
+            op    = node->nodeRep.binOpNode.op;
+            dataT = node->nodeRep.binOpNode.dataT;
+            if(node->nodeRep.binOpNode.retypeTo != unknown){
+                flags |= COMPACT_CONVERT;
+            }
             break;
-        case AST_NODE_FUNC_CALL:
-            for(int i = 0; i < node->nodeRep.funcCallNode.paramNum; i++){
-                freeASTNode(node->nodeRep.funcCallNode.paramExpr[i]);
+        case AST_NODE_LITERAL:
+            dataT = node->nodeRep.literalNode.dataT;
+            switch(node->nodeRep.literalNode.dataT){
+                case i32:
+                    memcpy(&a, &node->nodeRep.literalNode.value.intData, sizeof(astIdx));
+                    break;
+                case f64: {
+                    astIdx halves[2];
+                    memcpy(halves, &node->nodeRep.literalNode.value.floatData, sizeof(halves));
+                    a = halves[0];
+                    b = halves[1];
+                    break;
+                }
+                case u8:
+                case string:
+                    a = compactAddString(tree, node->nodeRep.literalNode.value.charData);
+                    break;
+                default:
+                    break;
             }
-            free(node->nodeRep.funcCallNode.paramExpr);
+            break;
+        case AST_NODE_VAR:
+            names[node->nodeRep.varNode.slot] = compactAddString(tree, node->nodeRep.varNode.id);
+            a = (astIdx)node->nodeRep.varNode.slot;
+            dataT = node->nodeRep.varNode.dataT;
+            break;
+        case AST_NODE_DEFVAR:
+            names[node->nodeRep.defVarNode.slot] = compactAddString(tree, node->nodeRep.defVarNode.id);
+            a = compactSubtree(tree, node->nodeRep.defVarNode.initExpr, names);
+            b = (astIdx)node->nodeRep.defVarNode.slot;
             break;
         case AST_UNUSED:
-            freeASTNode(node->nodeRep.unusedNode.expr);
+            a = compactSubtree(tree, node->nodeRep.unusedNode.expr, names);
             break;
-        case AST_NODE_ROOT:
-            freeASTNode(node->next);
-            node->next = NULL;
+        case AST_NODE_RETURN:
+            a = compactSubtree(tree, node->nodeRep.returnNode.returnExp, names);
+            dataT = node->nodeRep.returnNode.returnType;
+            if(node->nodeRep.returnNode.inMain){
+                flags |= COMPACT_IN_MAIN;
+            }
             break;
-
+        case AST_NODE_FUNC_CALL: {
+            astFuncCall *call = &node->nodeRep.funcCallNode;
+            a = compactAddString(tree, call->id);
+            astIdx *params = malloc(sizeof(astIdx) * (call->paramNum + 1));
+            if(params == NULL){
+                ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
+            }
+            for(int i = 0; i < call->paramNum; i++){
+                params[i] = compactSubtree(tree, call->paramExpr[i], names);
+            }
+            b = compactAddExtra(tree, call->paramNum + 1);
+            tree->extra[b] = (astIdx)call->paramNum;
+            memcpy(tree->extra + b + 1, params, sizeof(astIdx) * call->paramNum);
+            free(params);
+            dataT = call->retType;
+            if(call->builtin){
+                flags |= COMPACT_BUILTIN;
+            }
+            break;
+        }
         default:
             break;
     }
 
-    freeASTNode(node->next);
-    node->next = NULL;
-    free(node);
+    compactNode *newNode = &tree->nodes[idx]; // array could be moved by lowering of children
+    newNode->a     = a;
+    newNode->b     = b;
+    newNode->dataT = dataT;
+    newNode->flags = flags;
+    newNode->op    = op;
+    return idx;
+}
+
+/**
+ * @brief      Lowers a function definition.
+ * 
+ *             Names of frame slots are collected from nodes referencing the slots,
+ *             parameters take the first slots.
+ * 
+ * @param tree Pointer to the compact AST.
+ * @param node Node of the function definition.
+ * 
+ * @return     Index of the lowered node.
+ */
+astIdx compactFunction(compactAST *tree, astNode *node){
+    astDefFunc *fun   = &node->nodeRep.defFuncNode;
+    astIdx      idx   = compactAddNode(tree, AST_NODE_DEFFUNC);
+    astIdx     *names = malloc(sizeof(astIdx) * (fun->frameSize + 1));
+    if(names == NULL){
+        ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
+    }
+    for(int i = 0; i < fun->frameSize; i++){
+        names[i] = (i < fun->paramNum) ? compactAddString(tree, fun->paramNames[i]) : AST_NONE;
+    }
+
+    astIdx body = compactChain(tree, fun->body, names);
+
+    astIdx b = compactAddExtra(tree, 4 + fun->frameSize);
+    tree->extra[b]     = compactAddString(tree, fun->id);
+    tree->extra[b + 1] = (astIdx)fun->paramNum;
+    tree->extra[b + 2] = (astIdx)fun->frameSize;
+    tree->extra[b + 3] = (astIdx)fun->returnType;
+    memcpy(tree->extra + b + 4, names, sizeof(astIdx) * fun->frameSize);
+    free(names);
+
+    tree->nodes[idx].a     = body;
+    tree->nodes[idx].b     = b;
+    tree->nodes[idx].flags = fun->nullable ? COMPACT_NULLABLE : 0;
+    return idx;
+}
+
+/**
+ * @brief      Builds compact AST of the whole program.
+ * 
+ * @param tree Pointer to the compact AST to build, it is initialised.
+ * @param root Root of AST of the program (function definitions follow it).
+ */
+void buildCompactAST(compactAST *tree, astNode *root){
+    compactAST empty = {.nodes = NULL, .extra = NULL, .strtab = NULL, .first = AST_NONE};
+    *tree = empty;
+
+    astIdx prev = AST_NONE;
+    for(astNode *fun = root->next; fun != NULL; fun = fun->next){
+        astIdx idx = compactFunction(tree, fun);
+        if(prev == AST_NONE){
+            tree->first = idx;
+        }
+        else{
+            tree->nodes[prev].next = idx;
+        }
+        prev = idx;
+    }
+}
+
+/**
+ * @brief      Frees all arrays of compact AST.
+ * 
+ * @param tree Pointer to the compact AST.
+ */
+void freeCompactAST(compactAST *tree){
+    free(tree->nodes);
+    free(tree->extra);
+    free(tree->strtab);
+    tree->nodes  = NULL;
+    tree->extra  = NULL;
+    tree->strtab = NULL;
+    tree->nodeCnt = tree->extraCnt = tree->strtabLen = 0;
+    tree->nodeCap = tree->extraCap = tree->strtabCap = 0;
 }
 
 
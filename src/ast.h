@@ -21,6 +21,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "symtable.h"
 
 
@@ -81,6 +82,7 @@ typedef struct astWhile {
     
     bool      withNull;
     char     *id_without_null;
+    int       slotWithoutNull; // frame slot of id_without_null, -1 if not present
     astNode  *condition;
     astNode  *body;
     symtable *symtableWhile;
@@ -99,6 +101,7 @@ typedef struct astIfElse {
 typedef struct astIf {
     
     char     *id_without_null;
+    int       slotWithoutNull; // frame slot of id_without_null, -1 if not present
     symtable *symtableIf;
     astNode  *body;
 
@@ -114,6 +117,7 @@ typedef struct astElse {
 typedef struct astAssign {
 
     char    *id;
+    int      slot;
     dataType dataT;
     astNode *expression;
 
@@ -126,6 +130,7 @@ typedef struct astDefFunc {
     astNode  *body;
     char    **paramNames;  // added for easier access for codegen
     int       paramNum;
+    int       frameSize;  // number of variable slots, parameters occupy slots 0..paramNum-1
     dataType  returnType; 
     bool      nullable;   // whether the returned expression can be null
 
@@ -155,12 +160,14 @@ typedef struct astBinOp {
     astNode      *left;
     astNode      *right;
     dataType      dataT;
+    dataType      retypeTo; // pending implicit conversion of the subtree, after retype() conversion of the result of a division, unknown if none
 
 }astBinOp;
 
 typedef struct astLiteral {
 
     dataType dataT;
+    dataType retypeTo; // pending implicit conversion of the literal, unknown if none
     union{
         double floatData;
         int   intData;
@@ -173,6 +180,7 @@ typedef struct astVar {
 
     dataType dataT;
     char    *id;
+    int      slot;
     symNode *symtableEntry;
     bool isNullable;
 
@@ -180,19 +188,20 @@ typedef struct astVar {
 
 typedef struct astFuncCall {
 
-    dataType  retType;
-    char     *id;
-    symNode  *symtableEntry;
-    bool      builtin;
-    astNode **paramExpr;
-    int       paramNum;
-    bool      nullableRetType;
+    dataType       retType;
+    char          *id;
+    const symNode *symtableEntry;
+    bool           builtin;
+    astNode      **paramExpr;
+    int            paramNum;
+    bool           nullableRetType;
 
 }astFuncCall;
 
 typedef struct astDefVar {
 
     char    *id;             
+    int      slot;
     astNode *initExpr;       
     symNode *symtableEntry;
 
@@ -242,29 +251,102 @@ struct astNode {
 
 };
 
+/**
+ * Compact representation of AST used by code generator.
+ * 
+ * Nodes are stored in one array and reference each other by 32-bit indices,
+ * payloads of variable size (parameters, names of frame slots) are stored in array extra
+ * and strings in string table strtab (referenced by offset). Nothing in it is a pointer,
+ * so it can be stored in a file as it is. Meaning of a and b depends on type:
+ * 
+ *   WHILE      a = condition (EXPR), b = extra: [body, slotWithoutNull, name of id_without_null]
+ *   IFELSE     a = condition (EXPR), b = extra: [if body, else body, slotWithoutNull, name of id_without_null]
+ *   ASSIGN     a = expression (EXPR), b = slot
+ *   EXPR       a = expression tree
+ *   BINOP      a = left, b = right
+ *   LITERAL    a = i32 value or string offset, a and b = f64 value
+ *   VAR        a = slot
+ *   DEFVAR     a = init expression (EXPR), b = slot
+ *   UNUSED     a = expression (EXPR)
+ *   DEFFUNC    a = body, b = extra: [name, paramNum, frameSize, returnType, names of frameSize slots...]
+ *   RETURN     a = return expression (EXPR)
+ *   FUNC_CALL  a = name, b = extra: [paramNum, parameter expressions (EXPR)...]
+ * 
+ * Bodies point to the first statement directly (root nodes are left out), AST_NONE marks missing node.
+ * Nodes of a function follow its DEFFUNC node, before the DEFFUNC node of the next function.
+ */
+
+typedef uint32_t astIdx;
+
+#define AST_NONE ((astIdx)0xFFFFFFFF)
+
+#define COMPACT_WITH_NULL 0x1 // WHILE, IFELSE
+#define COMPACT_BUILTIN   0x2 // FUNC_CALL
+#define COMPACT_IN_MAIN   0x4 // RETURN
+#define COMPACT_NULLABLE  0x8 // DEFFUNC (returned expression can be null)
+#define COMPACT_CONVERT   0x10 // BINOP (result of division is converted to the other numeric type)
+
+typedef struct compactNode {
+
+    uint8_t type;   // astNodeType
+    uint8_t dataT;  // dataType of BINOP, LITERAL, VAR, EXPR, RETURN
+    uint8_t op;     // symbol_number of BINOP
+    uint8_t flags;  // COMPACT_* flags
+    astIdx  next;   // next in block of code
+    astIdx  a;
+    astIdx  b;
+
+}compactNode;
+
+typedef struct compactAST {
+
+    compactNode *nodes;
+    astIdx       nodeCnt;
+    astIdx       nodeCap;
+    astIdx      *extra;
+    astIdx       extraCnt;
+    astIdx       extraCap;
+    char        *strtab;
+    astIdx       strtabLen;
+    astIdx       strtabCap;
+    astIdx       first; // first function definition
+
+}compactAST;
+
 /** Functions for creating and manipulating AST nodes and AST */
 
-void createWhileNode(astNode *dest, bool withNull, char *id_without_null, astNode *cond, astNode *body, symtable *symtableW);
+void createWhileNode(astNode *dest, bool withNull, char *id_without_null, int slotWithoutNull, astNode *cond, astNode *body, symtable *symtableW);
 void createIfElseNode(astNode *dest, astNode *cond, astNode *ifPart, astNode *elsePart, bool withNull);
-void createIfNode(astNode *dest, char *id_without_null, symtable *symtable, astNode *body);
+void createIfNode(astNode *dest, char *id_without_null, int slotWithoutNull, symtable *symtable, astNode *body);
 void createElseNode(astNode *dest, symtable *symtableIf, astNode *body);
-void createAssignNode(astNode *dest, char *id, astNode *expression, dataType dataT);
+void createAssignNode(astNode *dest, char *id, int slot, astNode *expression, dataType dataT);
 void createDefVarNode(astNode *dest, char *id, astNode *initExpr, symNode *symtableEntry);
-void createDefFuncNode(astNode *dest, char *id, symtable *symtableFun, astNode *body, char **paranNames, int paramNum, dataType returnType, bool nullable);
+void createDefFuncNode(astNode *dest, char *id, symtable *symtableFun, astNode *body, char **paranNames, int paramNum, int frameSize, dataType returnType, bool nullable);
 void createReturnNode(astNode *dest, astNode *returnExp, dataType returnType, bool inMain);
 void createBinOpNode(astNode *dest, symbol_number op, astNode *left, astNode *right, dataType dataT);
 void createLiteralNode(astNode *dest, dataType dataT, void *value);
 void createVarNode(astNode *dest, char *id, dataType dataT, symNode *symtableEntry);
-void createFuncCallNode(astNode *dest, char *id, dataType retType, bool builtin, symNode *symtableEntry, astNode **exprParams, int paramNum, bool isNullable);
+void createFuncCallNode(astNode *dest, char *id, dataType retType, bool builtin, const symNode *symtableEntry, astNode **exprParams, int paramNum, bool isNullable);
 void createUnusedNode(astNode *dest, astNode *expr);
 void createExpressionNode(astNode *dest, dataType type, astNode *exprRoot, bool isNullable, bool duringCompile);
 astNode *createRootNode();
 
 void connectToBlock(astNode *toAdd, astNode *blockRoot);
-void freeASTNode(astNode *node);
 
 astNode *createAstNode();
 
+/** Functions for building compact AST */
+
+void   buildCompactAST  (compactAST *tree, astNode *root);
+void   freeCompactAST   (compactAST *tree);
+astIdx compactAddNode   (compactAST *tree, astNodeType type);
+astIdx compactAddExtra  (compactAST *tree, int cnt);
+astIdx compactAddString (compactAST *tree, char *str);
+char  *compactString    (compactAST *tree, astIdx offset);
+astIdx compactChain     (compactAST *tree, astNode *node, astIdx *names);
+astIdx compactSubtree   (compactAST *tree, astNode *node, astIdx *names);
+astIdx compactFunction  (compactAST *tree, astNode *node);
+
 /** Functions for printing .dot representation of AST */
 
 void printASTree(FILE *file, astNode *tree);
@@ -0,0 +1,295 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   ast_file.c
+ * 
+ * @brief  Saving compact AST to a binary file and mapping it back to memory.
+ * 
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ast_file.h"
+
+/**
+ * @brief       Writes compact AST to a file.
+ * 
+ * @param tree  Pointer to the compact AST.
+ * @param path  Path of the file, existing file is overwritten.
+ * 
+ * @return      true if the file was written, false otherwise.
+ */
+bool saveASTFile(compactAST *tree, const char *path){
+    astFileHeader header;
+    memcpy(header.magic, AST_FILE_MAGIC, sizeof(header.magic));
+    header.version   = AST_FILE_VERSION;
+    header.byteOrder = AST_FILE_BYTE_ORDER;
+    header.nodeCnt   = tree->nodeCnt;
+    header.extraCnt  = tree->extraCnt;
+    header.strtabLen = tree->strtabLen;
+    header.first     = tree->first;
+
+    FILE *file = fopen(path, "wb");
+    if(file == NULL){
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+           && fwrite(tree->nodes,  sizeof(compactNode), tree->nodeCnt,   file) == tree->nodeCnt
+           && fwrite(tree->extra,  sizeof(astIdx),      tree->extraCnt,  file) == tree->extraCnt
+           && fwrite(tree->strtab, sizeof(char),        tree->strtabLen, file) == tree->strtabLen;
+
+    if(fclose(file) != 0){
+        ok = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief       Checks that an offset refers to a string of the string table.
+ */
+static bool validString(compactAST *tree, astIdx offset){
+    return offset < tree->strtabLen; // string table ends with '\0', so the string is terminated
+}
+
+/**
+ * @brief       Checks a reference from one node to another.
+ * 
+ *              Nodes are lowered before their children and following statements, so only references
+ *              forward inside of the same function are valid. Every node can be referenced once,
+ *              so the code generator cannot loop or visit a node repeatedly.
+ * 
+ * @param tree  Pointer to the compact AST.
+ * @param seen  Flags of already referenced nodes.
+ * @param from  Index of the referencing node.
+ * @param to    Referenced index, AST_NONE is valid.
+ * @param end   Index of the first node after the function.
+ */
+static bool validChild(compactAST *tree, uint8_t *seen, astIdx from, astIdx to, astIdx end){
+    if(to == AST_NONE){
+        return true;
+    }
+    if(to <= from || to >= end || tree->nodes[to].type == AST_NODE_DEFFUNC || seen[to]){
+        return false;
+    }
+    seen[to] = 1;
+    return true;
+}
+
+/**
+ * @brief       Checks that a frame slot exists in the function and has a name.
+ */
+static bool validSlot(compactAST *tree, astIdx *names, astIdx frameSize, astIdx slot){
+    return slot < frameSize && validString(tree, names[slot]);
+}
+
+/**
+ * @brief       Checks that an extra payload of cnt items starting at b fits into the array.
+ */
+static bool validExtra(compactAST *tree, astIdx b, astIdx cnt){
+    return b <= tree->extraCnt && cnt <= tree->extraCnt - b;
+}
+
+#define EXTRA(k) (tree->extra[node->b + (k)]) // item of extra payload of the node, only after validExtra()
+
+/**
+ * @brief       Checks all indices of a compact AST loaded from a file.
+ * 
+ *              Indices of nodes, offsets to extra and string table and frame slots are checked
+ *              by type of the node, so the code generator does not read out of the arrays.
+ *              Functions have to be listed in order of their DEFFUNC nodes, which are followed
+ *              by all nodes of the function (as built by buildCompactAST()).
+ * 
+ * @param tree  Pointer to the compact AST.
+ * 
+ * @return      true if the tree is valid, false otherwise.
+ */
+static bool validTree(compactAST *tree){
+    if(tree->nodeCnt == 0){
+        return tree->first == AST_NONE;
+    }
+    if(tree->first != 0 || tree->nodes[0].type != AST_NODE_DEFFUNC){
+        return false; // nodes out of functions
+    }
+
+    uint8_t *seen = calloc(tree->nodeCnt, 1);
+    if(seen == NULL){
+        return false;
+    }
+
+    bool    ok        = true;
+    astIdx  end       = 0;    // first node after the current function
+    astIdx *names     = NULL; // names of frame slots of the current function
+    astIdx  frameSize = 0;
+    for(astIdx i = 0; ok && i < tree->nodeCnt; i++){
+        compactNode *node = &tree->nodes[i];
+
+        switch(node->type){
+            case AST_NODE_DEFFUNC:
+                for(end = i + 1; end < tree->nodeCnt && tree->nodes[end].type != AST_NODE_DEFFUNC; end++);
+                ok = node->next == (end < tree->nodeCnt ? end : AST_NONE)
+                  && validChild(tree, seen, i, node->a, end)
+                  && validExtra(tree, node->b, 4)
+                  && validExtra(tree, node->b + 4, EXTRA(2))
+                  && validString(tree, EXTRA(0))
+                  && EXTRA(1) <= EXTRA(2);
+                if(ok){
+                    names     = &EXTRA(4);
+                    frameSize = EXTRA(2);
+                }
+                for(astIdx slot = 0; ok && slot < frameSize; slot++){
+                    ok = (slot >= EXTRA(1) && names[slot] == AST_NONE) || validString(tree, names[slot]);
+                }
+                continue; // next is the following function
+            case AST_NODE_WHILE:
+                ok = validChild(tree, seen, i, node->a, end)
+                  && validExtra(tree, node->b, 3)
+                  && validChild(tree, seen, i, EXTRA(0), end)
+                  && (!(node->flags & COMPACT_WITH_NULL) || (validSlot(tree, names, frameSize, EXTRA(1)) && validString(tree, EXTRA(2))));
+                break;
+            case AST_NODE_IFELSE:
+                ok = validChild(tree, seen, i, node->a, end)
+                  && validExtra(tree, node->b, 4)
+                  && validChild(tree, seen, i, EXTRA(0), end)
+                  && validChild(tree, seen, i, EXTRA(1), end)
+                  && (!(node->flags & COMPACT_WITH_NULL) || (validSlot(tree, names, frameSize, EXTRA(2)) && validString(tree, EXTRA(3))));
+                break;
+            case AST_NODE_ASSIGN:
+            case AST_NODE_DEFVAR:
+                ok = validChild(tree, seen, i, node->a, end) && validSlot(tree, names, frameSize, node->b);
+                break;
+            case AST_NODE_EXPR:
+            case AST_UNUSED:
+            case AST_NODE_RETURN:
+                ok = validChild(tree, seen, i, node->a, end);
+                break;
+            case AST_NODE_BINOP:
+                ok = validChild(tree, seen, i, node->a, end) && validChild(tree, seen, i, node->b, end);
+                break;
+            case AST_NODE_LITERAL:
+                ok = (node->dataT != u8 && node->dataT != string) || validString(tree, node->a);
+                break;
+            case AST_NODE_VAR:
+                ok = validSlot(tree, names, frameSize, node->a);
+                break;
+            case AST_NODE_FUNC_CALL: {
+                ok = validString(tree, node->a)
+                  && validExtra(tree, node->b, 1)
+                  && validExtra(tree, node->b + 1, EXTRA(0));
+                for(astIdx param = 0; ok && param < EXTRA(0); param++){
+                    ok = validChild(tree, seen, i, EXTRA(param + 1), end);
+                }
+                if(ok && (node->flags & COMPACT_BUILTIN)){
+                    // code of builtins uses their parameters without checking the number
+                    const symNode *builtin = findBuiltin(tree->strtab + node->a);
+                    ok = builtin != NULL && (int)EXTRA(0) == builtin->data.data.fData->paramNum;
+                }
+                break;
+            }
+            default:
+                ok = false; // other types are not lowered
+                break;
+        }
+        ok = ok && validChild(tree, seen, i, node->next, end);
+    }
+
+    free(seen);
+    return ok;
+}
+
+/**
+ * @brief       Maps a file written by saveASTFile() to memory.
+ * 
+ *              Besides the header and sizes of the arrays, all indices in nodes are checked,
+ *              so a corrupted or stale file is rejected instead of being read out of bounds.
+ * 
+ * @param file  Pointer to the structure to fill, file->tree can be passed to the code generator.
+ * @param path  Path of the file.
+ * 
+ * @return      true if the file was mapped, false if it could not be read or is not a valid AST file.
+ */
+bool loadASTFile(astFile *file, const char *path){
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(astFileHeader)){
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void  *map  = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // mapping stays valid after closing
+    if(map == MAP_FAILED){
+        return false;
+    }
+
+    astFileHeader *header = map;
+    size_t expected = sizeof(astFileHeader)
+                    + (size_t)header->nodeCnt  * sizeof(compactNode)
+                    + (size_t)header->extraCnt * sizeof(astIdx)
+                    + header->strtabLen;
+
+    if(memcmp(header->magic, AST_FILE_MAGIC, sizeof(header->magic)) != 0
+       || header->version   != AST_FILE_VERSION
+       || header->byteOrder != AST_FILE_BYTE_ORDER
+       || expected != size
+       || (header->first != AST_NONE && header->first >= header->nodeCnt)
+       || (header->strtabLen > 0 && ((char *)map)[size - 1] != '\0')){
+        munmap(map, size);
+        return false;
+    }
+
+    char *data = (char *)map + sizeof(astFileHeader);
+
+    file->map     = map;
+    file->mapSize = size;
+
+    file->tree.nodes     = (compactNode *)data;
+    file->tree.nodeCnt   = header->nodeCnt;
+    file->tree.nodeCap   = 0;
+    data += (size_t)header->nodeCnt * sizeof(compactNode);
+
+    file->tree.extra     = (astIdx *)data;
+    file->tree.extraCnt  = header->extraCnt;
+    file->tree.extraCap  = 0;
+    data += (size_t)header->extraCnt * sizeof(astIdx);
+
+    file->tree.strtab    = data;
+    file->tree.strtabLen = header->strtabLen;
+    file->tree.strtabCap = 0;
+
+    file->tree.first     = header->first;
+
+    if(!validTree(&file->tree)){
+        unloadASTFile(file);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief       Unmaps a file mapped by loadASTFile().
+ * 
+ * @param file  Pointer to the mapped file.
+ */
+void unloadASTFile(astFile *file){
+    if(file->map != NULL){
+        munmap(file->map, file->mapSize);
+    }
+    file->map     = NULL;
+    file->mapSize = 0;
+}
+
+/* EOF ast_file.c */
@@ -0,0 +1,55 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   ast_file.h
+ * 
+ * @brief  Header file for binary files with compact AST.
+ * 
+ *         Compact AST (see ast.h) is stored exactly as it is in memory, so a file can be mapped
+ *         and handed to the code generator without any parsing. All references inside the
+ *         tree are indices, which makes the file position-independent.
+ * 
+ *         Layout of the file:
+ *           astFileHeader
+ *           compactNode nodes[nodeCnt]
+ *           astIdx      extra[extraCnt]
+ *           char        strtab[strtabLen]
+ * 
+ * @date   19.10.2026
+*/
+
+#ifndef AST_FILE_H
+#define AST_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+
+#define AST_FILE_MAGIC      "IFJ24AST"
+#define AST_FILE_VERSION    2          // increase on every change of compactNode or meaning of its fields
+#define AST_FILE_BYTE_ORDER 0x01020304 // files are only loaded on machines with the same byte order
+
+typedef struct astFileHeader{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeCnt;
+    uint32_t extraCnt;
+    uint32_t strtabLen;
+    uint32_t first;
+}astFileHeader;
+
+typedef struct astFile{
+    compactAST tree; // arrays point into the mapping, must not be freed by freeCompactAST()
+    void      *map;
+    size_t     mapSize;
+}astFile;
+
+bool saveASTFile  (compactAST *tree, const char *path);
+bool loadASTFile  (astFile *file, const char *path);
+void unloadASTFile(astFile *file);
+
+#endif //AST_FILE_H
+
+/* EOF ast_file.h */
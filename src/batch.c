@@ -0,0 +1,235 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   batch.c
+ *
+ * @brief  Implementation of batch mode compiling many programs on a pool of threads.
+ *
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L // getline, open_memstream, sysconf
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "batch.h"
+#include "ifj24.h"
+#include "parser.h"
+
+#define BATCH_PATH_LEN 4096
+
+typedef struct batchQueue {
+
+    char          **paths;
+    int             cnt;
+    int             next;    // index of the next program to compile
+    int            *results; // exit codes in order of paths
+    pthread_mutex_t lock;    // guards next and printing of diagnostics
+
+}batchQueue;
+
+/**
+ * @brief       Makes path of the generated code by replacing extension of the program.
+ *
+ * @return      true if the path fits into the buffer, false otherwise.
+ */
+static bool outputPath(const char *path, char *out, size_t size){
+    const char *slash = strrchr(path, '/');
+    const char *dot   = strrchr(path, '.');
+    int         len   = (dot != NULL && (slash == NULL || dot > slash)) ? (int)(dot - path) : (int)strlen(path);
+
+    return snprintf(out, size, "%.*s%s", len, path, BATCH_OUTPUT_EXT) < (int)size;
+}
+
+/**
+ * @brief       Compiles one program to its output file, which is removed if the compilation fails.
+ *
+ * @param path        Path of the program.
+ * @param diagnostics Stream error messages are printed to.
+ *
+ * @return      Exit code of the compilation.
+ */
+static int compileFile(const char *path, FILE *diagnostics){
+    char outPath[BATCH_PATH_LEN];
+    if(!outputPath(path, outPath, sizeof(outPath))){
+        fprintf(diagnostics, "\nERROR NUMBER %d: Path %s is too long\n", ERR_INTERNAL, path);
+        return ERR_INTERNAL;
+    }
+
+    FILE *in  = fopen(path, "r");
+    FILE *out = in != NULL ? fopen(outPath, "w") : NULL;
+    if(in == NULL || out == NULL){
+        fprintf(diagnostics, "\nERROR NUMBER %d: Cannot open %s\n", ERR_INTERNAL, in == NULL ? path : outPath);
+        if(in != NULL) fclose(in);
+        return ERR_INTERNAL;
+    }
+
+    int ret = ifj24CompileStream(in, out, diagnostics);
+    fclose(in);
+    if(fclose(out) != 0 && ret == 0){
+        fprintf(diagnostics, "\nERROR NUMBER %d: Cannot write %s\n", ERR_INTERNAL, outPath);
+        ret = ERR_INTERNAL;
+    }
+    if(ret != 0){
+        unlink(outPath);
+    }
+    return ret;
+}
+
+/**
+ * @brief       Compiles programs from the queue until it is empty.
+ *
+ * @param arg   Pointer to the queue.
+ */
+static void *batchWorker(void *arg){
+    batchQueue *queue = arg;
+
+    while(true){
+        pthread_mutex_lock(&queue->lock);
+        int i = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+        if(i >= queue->cnt){
+            break;
+        }
+
+        char  *diag    = NULL;
+        size_t diagLen = 0;
+        FILE  *err     = open_memstream(&diag, &diagLen);
+        if(err == NULL){
+            queue->results[i] = ERR_INTERNAL;
+            continue;
+        }
+        queue->results[i] = compileFile(queue->paths[i], err);
+        fclose(err);
+
+        if(diagLen > 0){ // messages of one program are kept together
+            pthread_mutex_lock(&queue->lock);
+            fprintf(stderr, "%s:%s\n", queue->paths[i], diag);
+            pthread_mutex_unlock(&queue->lock);
+        }
+        free(diag);
+    }
+
+    exp_release_all(); // memory of the thread kept for the next compilation
+    return NULL;
+}
+
+/**
+ * @brief       Compiles programs concurrently, each to its own output file.
+ *
+ *              Exit code of every program is printed to standard output in order of paths,
+ *              error messages are printed to standard error output prefixed by the path.
+ *
+ * @param paths Paths of the programs.
+ * @param cnt   Number of the programs.
+ * @param jobs  Number of threads, number of processors is used when less than 1.
+ *
+ * @return      0 if all programs were compiled, exit code of the first failed program otherwise.
+ */
+int runBatch(char **paths, int cnt, int jobs){
+    if(jobs < 1){
+        jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if(jobs > BATCH_MAX_JOBS) jobs = BATCH_MAX_JOBS;
+    if(jobs > cnt) jobs = cnt;
+    if(jobs < 1) jobs = 1;
+
+    batchQueue queue = {.paths = paths, .cnt = cnt, .next = 0};
+    queue.results    = calloc(cnt > 0 ? cnt : 1, sizeof(int));
+    if(queue.results == NULL){
+        fprintf(stderr, "\nERROR NUMBER %d: Malloc fail in batch mode.\n", ERR_INTERNAL);
+        return ERR_INTERNAL;
+    }
+    pthread_mutex_init(&queue.lock, NULL);
+
+    pthread_t threads[BATCH_MAX_JOBS];
+    int       started = 0;
+    while(started < jobs && pthread_create(&threads[started], NULL, batchWorker, &queue) == 0){
+        started++;
+    }
+    if(started == 0){ // compile in this thread then
+        batchWorker(&queue);
+    }
+    for(int i = 0; i < started; i++){
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&queue.lock);
+
+    int ret = 0;
+    for(int i = 0; i < cnt; i++){
+        printf("%s %d\n", paths[i], queue.results[i]);
+        if(ret == 0){
+            ret = queue.results[i];
+        }
+    }
+    free(queue.results);
+    return ret;
+}
+
+/**
+ * @brief       Reads paths of programs from a manifest, one path per line.
+ *
+ * @param path  Path of the manifest, empty lines are skipped.
+ * @param cnt   Pointer where number of the read paths is stored.
+ *
+ * @return      Allocated array of paths, NULL if the manifest could not be read.
+ */
+char **readManifest(const char *path, int *cnt){
+    FILE *file = fopen(path, "r");
+    if(file == NULL){
+        return NULL;
+    }
+
+    char  **paths = NULL;
+    int     cap   = 0;
+    char   *line  = NULL;
+    size_t  size  = 0;
+    ssize_t len;
+    *cnt = 0;
+
+    while((len = getline(&line, &size, file)) != -1){
+        while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')){
+            line[--len] = '\0';
+        }
+        if(len == 0){
+            continue;
+        }
+
+        if(*cnt == cap){
+            cap = cap == 0 ? 64 : cap * 2;
+            char **tmp = realloc(paths, sizeof(char *) * cap);
+            if(tmp == NULL){
+                break;
+            }
+            paths = tmp;
+        }
+        paths[*cnt] = line; // ownership of the line is taken
+        (*cnt)++;
+        line = NULL;
+        size = 0;
+    }
+
+    bool ok = !ferror(file) && feof(file);
+    free(line);
+    fclose(file);
+    if(!ok){
+        freeManifest(paths, *cnt);
+        return NULL;
+    }
+    return paths != NULL ? paths : calloc(1, sizeof(char *));
+}
+
+/**
+ * @brief       Frees paths read by readManifest.
+ */
+void freeManifest(char **paths, int cnt){
+    for(int i = 0; i < cnt; i++){
+        free(paths[i]);
+    }
+    free(paths);
+}
+
+/* EOF batch.c */
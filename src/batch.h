@@ -0,0 +1,27 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   batch.h
+ *
+ * @brief  Header file for batch mode compiling many programs on a pool of threads.
+ *
+ *         Program PATH.ext is compiled to PATH.ifjcode, which is only created when
+ *         the compilation succeeds. State of a compilation is thread local (see thread_local.h),
+ *         table of builtin functions is shared.
+ *
+ * @date   19.10.2026
+*/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#define BATCH_OUTPUT_EXT ".ifjcode"
+#define BATCH_MAX_JOBS   256
+
+int    runBatch     (char **paths, int cnt, int jobs);
+char **readManifest (const char *path, int *cnt);
+void   freeManifest (char **paths, int cnt);
+
+#endif //BATCH_H
+
+/* EOF batch.h */
@@ -4,11 +4,17 @@
  * @file   code_buffer.c
  * @brief  Header file for managing a dynamic buffer that stores stirngs.
  *         The buffer supports dynamic expansion and safe data pushing.
- *         Also support to add Flag to node, and store contentet after flagged node.
+ *         Code is split into named sections, which can be appended independently.
  * 
  * @author xskovaj00
  * @date   6.11.2024
  */
+#define _POSIX_C_SOURCE 200809L // fileno
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/uio.h>
 #include "code_buffer.h"
 
 
@@ -23,10 +29,17 @@ bool buf_init(Buffer_ll **buf){
     if (*buf == NULL) {
         return false;
     }
-    (*buf)->first = NULL;
-    (*buf)->last = NULL;
-    (*buf)-> flag = NULL;
-    (*buf)->tmp = NULL;
+    (*buf)->sections = NULL;
+    (*buf)->section_cnt = 0;
+    (*buf)->section_cap = 0;
+    (*buf)->current = -1;
+    (*buf)->size = 0;
+    (*buf)->page = NULL;
+    (*buf)->side = NULL;
+    (*buf)->line = NULL;
+    (*buf)->nodes = NULL;
+    (*buf)->nodes_left = 0;
+    (*buf)->slabs = NULL;
     return true;
 }
 
@@ -34,19 +47,153 @@ bool buf_init(Buffer_ll **buf){
 /**
  * @brief Creates a new node for the buffer linked list.
  * 
+ *        Nodes are allocated in slabs, they are freed with the buffer.
+ * 
+ * @param buf Pointer to the buffer linked list.
  * @return Pointer to the newly created node, or NULL if memory allocation fails.
  */
-Buffer_node *buf_new_node(){
-    Buffer_node *new = malloc(sizeof(Buffer_node));
-    if(new == NULL){
-        return NULL;
+Buffer_node *buf_new_node(Buffer_ll *buf){
+    if(buf->nodes_left == 0){
+        // slab starts with pointer to the previous slab, nodes follow
+        void **slab = malloc(sizeof(Buffer_node) * (BUF_NODE_SLAB + 1));
+        if(slab == NULL){
+            return NULL;
+        }
+        *slab = buf->slabs;
+        buf->slabs = slab;
+        buf->nodes = (Buffer_node *)slab + 1;
+        buf->nodes_left = BUF_NODE_SLAB;
     }
+    Buffer_node *new = buf->nodes++;
+    buf->nodes_left--;
     new->next = NULL;
     new->str = NULL;
+    new->len = 0;
     return new;
 }
 
 
+/**
+ * @brief Creates a new empty section at the end of the code and makes it current.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @param name Name of the section.
+ * @return Index of the section, or -1 if memory allocation fails.
+ */
+int buf_section(Buffer_ll *buf, const char *name){
+    if(buf->section_cnt == buf->section_cap){
+        int cap = (buf->section_cap == 0) ? 16 : buf->section_cap * 2;
+        Buffer_section *tmp = realloc(buf->sections, sizeof(Buffer_section) * cap);
+        if(tmp == NULL){
+            return -1;
+        }
+        buf->sections = tmp;
+        buf->section_cap = cap;
+    }
+    Buffer_section *sec = &buf->sections[buf->section_cnt];
+    sec->name = malloc(strlen(name) + 1);
+    if(sec->name == NULL){
+        return -1;
+    }
+    strcpy(sec->name, name);
+    sec->first = NULL;
+    sec->last = NULL;
+    buf->current = buf->section_cnt;
+    return buf->section_cnt++;
+}
+
+
+/**
+ * @brief Finds a section by its name.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @param name Name of the section.
+ * @return Index of the first section with the name, or -1 if there is none.
+ */
+int buf_find_section(Buffer_ll *buf, const char *name){
+    for(int i = 0; i < buf->section_cnt; i++){
+        if(strcmp(buf->sections[i].name, name) == 0){
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * @brief Selects the section lines are pushed to.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @param section Index of the section.
+ */
+void buf_select(Buffer_ll *buf, int section){
+    buf->current = section;
+}
+
+
+/**
+ * @brief Returns length of the accumulator string.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @return Number of characters added since the last push.
+ */
+size_t buf_line_len(Buffer_ll *buf){
+    return (buf->page != NULL) ? (size_t)(buf->page->data + buf->page->used - buf->line) : 0;
+}
+
+
+/**
+ * @brief Makes room for len more characters in the accumulator string.
+ * 
+ *        When the current page is full, a new one is allocated and the accumulator
+ *        string is moved to it, so a line is always contiguous.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @param len Number of characters to be added.
+ * @return true if there is enough room, false if memory allocation fails.
+ */
+bool buf_reserve(Buffer_ll *buf, size_t len){
+    if(buf->page != NULL && buf->page->size - buf->page->used >= len){
+        return true;
+    }
+    size_t line_len = buf_line_len(buf);
+    size_t size = BUF_PAGE_SIZE;
+    while(size < line_len + len){
+        size *= 2;
+    }
+    Buffer_page *page = malloc(sizeof(Buffer_page) + size);
+    if(page == NULL){
+        return false;
+    }
+    page->size = size;
+    page->used = line_len;
+    if(line_len > 0){
+        memcpy(page->data, buf->line, line_len);
+        buf->page->used -= line_len;
+    }
+    page->next = buf->page;
+    buf->page = page;
+    buf->line = page->data;
+    return true;
+}
+
+
+/**
+ * @brief Adds len characters of a string to the accumulator string.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @param str String to be added to the accumulator string.
+ * @param len Number of characters to be added.
+ * @return true if the string was successfully added, false otherwise.
+ */
+bool buf_add_len(Buffer_ll *buf, const char *str, size_t len){
+    if(!buf_reserve(buf, len)) return false;
+    memcpy(buf->page->data + buf->page->used, str, len);
+    buf->page->used += len;
+    return true;
+}
+
+
 /**
  * @brief Adds a string to the accumulator string.
  * 
@@ -55,47 +202,107 @@ Buffer_node *buf_new_node(){
  * @return true if the string was successfully added, false otherwise.
  */
 bool buf_add(Buffer_ll *buf, char *str){
-    size_t old_len = (buf->tmp != NULL) ? strlen(buf->tmp) : 0;
-    char *tmp = realloc(buf->tmp, sizeof(char)*(strlen(str)+old_len+1));
-    if(tmp == NULL){
-        return false;
-    }
-    if(buf->tmp == NULL){
-        buf->tmp = tmp;
-        strcpy(buf->tmp, str);
-    }
-    else{
-        buf->tmp = tmp;
-        strcat(buf->tmp, str);
+    return buf_add_len(buf, str, strlen(str));
+}
+
+
+/**
+ * @brief Copies a line to the side page, allocating a new one when it is full.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @param str Line to be copied.
+ * @param len Length of the line.
+ * @return Pointer to the copy, or NULL if memory allocation fails.
+ */
+static char *buf_side_copy(Buffer_ll *buf, const char *str, size_t len){
+    Buffer_page *page = buf->side;
+    if(page == NULL || page->size - page->used < len){
+        size_t size = BUF_SIDE_PAGE_SIZE;
+        while(size < len){
+            size *= 2;
+        }
+        page = malloc(sizeof(Buffer_page) + size);
+        if(page == NULL){
+            return NULL;
+        }
+        page->size = size;
+        page->used = 0;
+        page->next = buf->side;
+        buf->side = page;
     }
-    return true;
+    char *copy = page->data + page->used;
+    memcpy(copy, str, len);
+    page->used += len;
+    return copy;
 }
 
 
 /**
- * @brief Pushes the accumulator string content into a new node of the linked list.
+ * @brief Pushes the accumulator string content into a section.
+ * 
+ *        Line of the current section stays in the page, line of another section is moved
+ *        to the side page, so code of both stays contiguous. Line extends the last node
+ *        of the section when it directly follows it.
  * 
  * @param buf Pointer to the buffer linked list.
+ * @param section Index of the section.
  * @return true if the content was successfully pushed, false otherwise.
  */
-bool buf_push(Buffer_ll *buf){
-    Buffer_node *new = buf_new_node();
+bool buf_push_to(Buffer_ll *buf, int section){
+    if(section < 0 || section >= buf->section_cnt) return false;
+    Buffer_section *sec = &buf->sections[section];
+    size_t len = buf_line_len(buf);
+    if(len == 0){
+        return true;
+    }
+
+    char *str = buf->line;
+    if(section != buf->current){
+        str = buf_side_copy(buf, buf->line, len);
+        if(str == NULL){
+            return false;
+        }
+        buf->page->used -= len; // following lines of the current section take its place
+    }
+    else{
+        buf->line += len;
+    }
+    buf->size += len;
+
+    if(sec->last != NULL && sec->last->str + sec->last->len == str){
+        sec->last->len += len;
+        return true;
+    }
+
+    Buffer_node *new = buf_new_node(buf);
     if(new == NULL){
         return false;
     }
-    if(buf->first == NULL){
-        buf->first = new;
+    new->str = str;
+    new->len = len;
+
+    if(sec->first == NULL){
+        sec->first = new;
     }
     else{
-        buf->last->next = new;
+        sec->last->next = new;
     }
-    buf->last = new;
-    new->str = buf->tmp;
-    buf->tmp = NULL;
+    sec->last = new;
     return true;
 }
 
 
+/**
+ * @brief Pushes the accumulator string content into the current section.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @return true if the content was successfully pushed, false otherwise.
+ */
+bool buf_push(Buffer_ll *buf){
+    return buf_push_to(buf, buf->current);
+}
+
+
 /**
  * @brief Adds a string to the accumulator string and pushes it into the linked list.
  * 
@@ -112,22 +319,76 @@ bool buf_add_push(Buffer_ll *buf, char *str){
 
 
 /**
- * @brief Sets a flag to mark a specific node in the linked list.
+ * @brief Formats an integer in decimal, like "%d" of printf.
  * 
- * @param buf Pointer to the buffer linked list.
+ * @param out Output of at least BUF_INT_LEN characters, it is not terminated by '\0'.
+ * @param num Integer to be formatted.
+ * @return Number of written characters.
  */
-void buf_add_flag(Buffer_ll *buf){
-    buf->flag = buf->last;
+size_t buf_format_int(char *out, int num){
+    char digits[BUF_INT_LEN];
+    size_t cnt = 0;
+    size_t len = 0;
+    unsigned int val = num < 0 ? 0u - (unsigned int)num : (unsigned int)num;
+    do{
+        digits[cnt++] = '0' + val % 10;
+        val /= 10;
+    }while(val > 0);
+    if(num < 0){
+        out[len++] = '-';
+    }
+    while(cnt > 0){
+        out[len++] = digits[--cnt];
+    }
+    return len;
 }
 
 
 /**
- * @brief Deletes the flag from the buffer linked list.
+ * @brief Formats a floating-point number (64 bit) in hexadecimal, like "%a" of printf.
  * 
- * @param buf Pointer to the buffer linked list.
+ *        Normal numbers are written as 0x1.<fraction>p<exponent> without trailing zeros
+ *        of the fraction, subnormal numbers as 0x0.<fraction>p-1022.
+ * 
+ * @param out Output of at least BUF_FLOAT_LEN characters, it is not terminated by '\0'.
+ * @param num Floating-point number to be formatted.
+ * @return Number of written characters.
  */
-void buf_delete_flag(Buffer_ll *buf){
-    buf->flag = NULL;
+size_t buf_format_float(char *out, double num){
+    static const char hex[] = "0123456789abcdef";
+    uint64_t bits;
+    memcpy(&bits, &num, sizeof(bits));
+    uint64_t fraction = bits & 0xfffffffffffffull;
+    int exponent = (int)(bits >> 52 & 0x7ff);
+    size_t len = 0;
+
+    if(bits >> 63){
+        out[len++] = '-';
+    }
+    if(exponent == 0x7ff){
+        memcpy(out + len, fraction != 0 ? "nan" : "inf", 3);
+        return len + 3;
+    }
+    out[len++] = '0';
+    out[len++] = 'x';
+    out[len++] = exponent != 0 ? '1' : '0';
+    if(fraction != 0){
+        out[len++] = '.';
+        for(int shift = 48; fraction != 0; shift -= 4){
+            out[len++] = hex[fraction >> shift & 0xf];
+            fraction &= ((uint64_t)1 << shift) - 1;
+        }
+    }
+    out[len++] = 'p';
+    if(exponent != 0){
+        exponent -= 1023;
+    }
+    else if(bits << 1 != 0){
+        exponent = -1022;
+    }
+    out[len++] = exponent < 0 ? '-' : '+';
+    len += buf_format_int(out + len, exponent < 0 ? -exponent : exponent);
+    return len;
 }
 
 
@@ -139,9 +400,8 @@ void buf_delete_flag(Buffer_ll *buf){
  * @return true if the operation was successful, false otherwise.
  */
 bool buf_add_int(Buffer_ll *buf, int num){
-    char str[30];  
-    sprintf(str, "%d", num);
-    if(!buf_add(buf, str)) return false;
+    if(!buf_reserve(buf, BUF_INT_LEN)) return false;
+    buf->page->used += buf_format_int(buf->page->data + buf->page->used, num);
     return true;
 }
 
@@ -154,30 +414,107 @@ bool buf_add_int(Buffer_ll *buf, int num){
  * @return true if the operation was successful, false otherwise.
  */
 bool buf_add_float(Buffer_ll *buf, double num){
-    char str[100];  
-    sprintf(str, "%a", num);
-    if(!buf_add(buf, str)) return false;
+    if(!buf_reserve(buf, BUF_FLOAT_LEN)) return false;
+    buf->page->used += buf_format_float(buf->page->data + buf->page->used, num);
     return true;
 }
 
 
+/**
+ * @brief Characters which are written as an escape sequence \xyz in string literals
+ *        (control characters, whitespace, '#' and '\').
+ */
+static const unsigned char escaped_char[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+
+/**
+ * @brief Formats a string with escaped characters, runs of characters which are not
+ *        escaped are copied at once.
+ * 
+ * @param out Output of at least 4 * len characters, it is not terminated by '\0'.
+ * @param str String to be formatted.
+ * @param len Length of the string.
+ * @return Number of written characters.
+ */
+size_t buf_format_string(char *out, const char *str, size_t len){
+    const unsigned char *src = (const unsigned char *)str;
+    const unsigned char *end = src + len;
+    char *dst = out;
+    while(src < end){
+        const unsigned char *run = src;
+        while(src < end && !escaped_char[*src]){
+            src++;
+        }
+        memcpy(dst, run, src - run);
+        dst += src - run;
+        if(src < end){
+            dst[0] = '\\';
+            dst[1] = '0';
+            dst[2] = '0' + *src / 10;
+            dst[3] = '0' + *src % 10;
+            dst += 4;
+            src++;
+        }
+    }
+    return dst - out;
+}
+
+
 /**
  * @brief Adds a string  Adds a string with escaped characters to the accumulator string.
  * 
+ *        Room for the longest possible result is reserved once, the string is escaped in place.
+ * 
  * @param buf Pointer to the buffer linked list.
  * @param str String to be added.
  * @return true if the operation was successful, false otherwise.
  */
 bool buf_add_string(Buffer_ll *buf, char *str){
-    char tmp[5];
-    for(size_t i = 0; i < strlen(str); i++){
-        if(str[i] <= 32 || str[i] == 35 || str[i] == 92){
-            sprintf(tmp, "\\%03d", str[i]);
-            if(!buf_add(buf, tmp)) return false;
+    size_t len = strlen(str);
+    if(!buf_reserve(buf, 4 * len)) return false;
+    buf->page->used += buf_format_string(buf->page->data + buf->page->used, str, len);
+    return true;
+}
+
+
+/**
+ * @brief Writes all vectors to a file descriptor, repeating partial writes.
+ * 
+ * @param fd File descriptor.
+ * @param iov Array of vectors, it is modified.
+ * @param cnt Number of vectors.
+ * @return true if everything was written, false otherwise.
+ */
+static bool write_vectors(int fd, struct iovec *iov, int cnt){
+    while(cnt > 0){
+        ssize_t n = writev(fd, iov, cnt);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return false;
+        while(cnt > 0 && (size_t)n >= iov->iov_len){
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
         }
-        else{
-            sprintf(tmp, "%c", str[i]);
-            if(!buf_add(buf, tmp)) return false;
+        if(cnt > 0){
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
         }
     }
     return true;
@@ -185,47 +522,166 @@ bool buf_add_string(Buffer_ll *buf, char *str){
 
 
 /**
- * @brief Pushes the accumulator string content into a new node after the flagged node.
+ * @brief Prints the content of the buffer linked list to a file stream.
+ * 
+ *        Big content of a stream with a file descriptor is written straight from the pages
+ *        by writev, BUF_IOV_CNT nodes per call, without copying to the buffer of the stream.
+ *        Other streams (in memory) and small content go through stdio.
  * 
  * @param buf Pointer to the buffer linked list.
+ * @param stream File stream where the content will be printed.
  * @return true if the operation was successful, false otherwise.
  */
-bool buf_push_after_flag(Buffer_ll *buf){
-    if(buf->flag == NULL) return false;
-    Buffer_node *new = buf_new_node();
-    if(new == NULL){
+bool fprint_buffer(Buffer_ll *buf, FILE *stream) {
+    if (buf == NULL || stream == NULL) {
         return false;
     }
-    new->str = buf->tmp;
-    buf->tmp = NULL;
-    
-    if(buf->flag == buf->last){
-        buf->last = new;
+
+    int fd = (buf->size >= BUF_WRITEV_MIN) ? fileno(stream) : -1;
+    if(fd < 0){
+        for(int i = 0; i < buf->section_cnt; i++){
+            for(Buffer_node *tmp = buf->sections[i].first; tmp != NULL; tmp = tmp->next){
+                if(fwrite(tmp->str, 1, tmp->len, stream) != tmp->len) return false;
+            }
+        }
+        return true;
     }
 
-    new->next = buf->flag->next;
-    buf->flag->next = new;
-    return true;
+    // code already printed to the stream has to be written first
+    if(fflush(stream) != 0) return false;
+
+    struct iovec iov[BUF_IOV_CNT];
+    int cnt = 0;
+    for(int i = 0; i < buf->section_cnt; i++){
+        for(Buffer_node *tmp = buf->sections[i].first; tmp != NULL; tmp = tmp->next){
+            iov[cnt].iov_base = tmp->str;
+            iov[cnt].iov_len = tmp->len;
+            if(++cnt == BUF_IOV_CNT){
+                if(!write_vectors(fd, iov, cnt)) return false;
+                cnt = 0;
+            }
+        }
+    }
+    return write_vectors(fd, iov, cnt);
+}
+
+/**
+ * @brief Joins content of sections from the given one to the last one.
+ * 
+ * @param buf Pointer to the buffer linked list.
+ * @param from Index of the first section to join.
+ * @return Allocated string, or NULL if memory allocation fails.
+ */
+char *buf_to_string(Buffer_ll *buf, int from){
+    size_t len = 0;
+    for(int i = from; i < buf->section_cnt; i++){
+        for(Buffer_node *tmp = buf->sections[i].first; tmp != NULL; tmp = tmp->next){
+            len += tmp->len;
+        }
+    }
+
+    char *str = malloc(len + 1);
+    if(str == NULL){
+        return NULL;
+    }
+    char *end = str;
+    for(int i = from; i < buf->section_cnt; i++){
+        for(Buffer_node *tmp = buf->sections[i].first; tmp != NULL; tmp = tmp->next){
+            memcpy(end, tmp->str, tmp->len);
+            end += tmp->len;
+        }
+    }
+    *end = '\0';
+    return str;
 }
 
 
 /**
- * @brief Prints the content of the buffer linked list to a file stream.
+ * @brief Frees a list of pages.
+ * 
+ * @param page First page of the list, may be NULL.
+ */
+static void buf_free_pages(Buffer_page *page){
+    while(page != NULL){
+        Buffer_page *next = page->next;
+        free(page);
+        page = next;
+    }
+}
+
+
+/**
+ * @brief Prints all sections to a file stream and empties the buffer.
+ * 
+ *        Memory of the printed code is kept for the following code: the current pages
+ *        and the newest slab of nodes are reused, older ones are freed. So the buffer
+ *        only grows to the size of code between two flushes.
  * 
  * @param buf Pointer to the buffer linked list.
  * @param stream File stream where the content will be printed.
  * @return true if the operation was successful, false otherwise.
  */
-bool fprint_buffer(Buffer_ll *buf, FILE *stream) {
-    if (buf == NULL || stream == NULL) {
-        return false;
+bool buf_flush(Buffer_ll *buf, FILE *stream){
+    if(!fprint_buffer(buf, stream)) return false;
+
+    for(int i = 0; i < buf->section_cnt; i++){
+        free(buf->sections[i].name);
+    }
+    buf->section_cnt = 0;
+    buf->current = -1;
+    buf->size = 0;
+
+    if(buf->page != NULL){
+        // accumulator string, if any, moves to the start of the page
+        size_t line_len = buf_line_len(buf);
+        memmove(buf->page->data, buf->line, line_len);
+        buf->page->used = line_len;
+        buf->line = buf->page->data;
+        buf_free_pages(buf->page->next);
+        buf->page->next = NULL;
     }
-    Buffer_node *tmp = buf->first;
-    while(tmp != NULL){
-        if(tmp->str != NULL) fprintf(stream, "%s", tmp->str);
-        tmp = tmp->next;
+    if(buf->side != NULL){
+        buf->side->used = 0;
+        buf_free_pages(buf->side->next);
+        buf->side->next = NULL;
+    }
+
+    if(buf->slabs != NULL){
+        void **slab = buf->slabs;
+        while(*slab != NULL){
+            void *next = *(void **)*slab;
+            free(*slab);
+            *slab = next;
+        }
+        buf->nodes = (Buffer_node *)slab + 1;
+        buf->nodes_left = BUF_NODE_SLAB;
     }
     return true;
 }
 
-/* EOF code_buffer.c */
\ No newline at end of file
+
+/**
+ * @brief Frees the buffer linked list with all its sections, pages and nodes.
+ * 
+ * @param buf Pointer to the buffer linked list, may be NULL.
+ */
+void buf_free(Buffer_ll *buf){
+    if(buf == NULL){
+        return;
+    }
+    buf_free_pages(buf->page);
+    buf_free_pages(buf->side);
+    for(int i = 0; i < buf->section_cnt; i++){
+        free(buf->sections[i].name);
+    }
+    free(buf->sections);
+    while(buf->slabs != NULL){
+        void *next = *(void **)buf->slabs;
+        free(buf->slabs);
+        buf->slabs = next;
+    }
+    free(buf);
+}
+
+
+/* EOF code_buffer.c */
@@ -4,7 +4,8 @@
  * @file   code_buffer.h
  * @brief  Header file for managing a dynamic buffer that stores stirngs.
  *         The buffer supports dynamic expansion and safe data pushing.
- *         Also support to add Flag to node, and store contentet after flagged node.
+ *         Strings are stored in large pages, nodes of the list refer to them.
+ *         Code is split into named sections, which can be appended independently.
  * 
  * @author xskovaj00
  * @date   6.11.2024
@@ -30,44 +31,100 @@
     #endif
 #endif
 
+#define BUF_PAGE_SIZE  (64 * 1024) // size of pages the code is written to, longer lines get a bigger page
+#define BUF_SIDE_PAGE_SIZE (16 * 1024) // size of pages for lines pushed to other than the current section
+#define BUF_NODE_SLAB  256         // number of nodes allocated at once
+#define BUF_IOV_CNT    1024        // number of nodes written by one writev call (IOV_MAX on Linux)
+#define BUF_WRITEV_MIN (256 * 1024) // smaller content is printed through stdio
+#define BUF_FLUSH_SIZE (1024 * 1024) // streamed code is printed when this much is buffered
+#define BUF_INT_LEN    12          // longest formatted int, "-2147483648"
+#define BUF_FLOAT_LEN  32          // longest formatted double, "-0x1.fffffffffffffp+1023"
+
+/**
+ * @struct Buffer_page
+ * @brief  Represents a page of memory the code is written to.
+ * 
+ * Lines are appended to the current page in place, without separate allocations.
+ */
+typedef struct Buffer_page{
+    struct Buffer_page *next;   ///< Pointer to the previous page
+    size_t used;                ///< Number of used bytes
+    size_t size;                ///< Size of data
+    char data[];                ///< Written code
+} Buffer_page;
+
 /**
  * @struct Buffer_node
  * @brief  Represents a single node in the linked list buffer.
  * 
- * Each node contains a dynamically allocated string and a pointer to the next node.
+ * Each node refers to a contiguous run of lines stored in a page and a pointer to the next node.
+ * Following lines are added to the last node of a section while they are contiguous, so there are
+ * about as many nodes as pages and switches of the current section.
  */
 typedef struct Buffer_node{
-    char *str;  ///< Pointer to the stored string
+    char *str;  ///< Pointer to the stored lines, not terminated by '\0'
+    size_t len; ///< Length of the stored lines
     struct Buffer_node *next;   ///< Pointer to the next node in the list
 } Buffer_node;
 
 
+/**
+ * @struct Buffer_section
+ * @brief  Represents a named part of the code, appended independently of other sections.
+ */
+typedef struct {
+    char *name;         ///< Name of the section
+    Buffer_node *first; ///< Pointer to the first node of the section
+    Buffer_node *last;  ///< Pointer to the last node of the section
+} Buffer_section;
+
+
 /**
  * @struct Buffer_ll
  * @brief  Represents the linked list buffer structure.
  * 
+ * Code is split into sections, which are concatenated in order of their creation.
+ * Lines are pushed to the current section, or to any other section by buf_push_to.
+ * The line being built (accumulator string) is written to the end of the current page.
  */
 typedef struct {
-    Buffer_node *first; ///< Pointer to the first node in the list
-    Buffer_node *last;  ///< Pointer to the last node in the list
-    Buffer_node *flag;  ///< Pointer to a flagged node
-    char *tmp;           ///< Accumulator string
+    Buffer_section *sections;   ///< Sections in order of creation
+    int section_cnt;            ///< Number of sections
+    int section_cap;            ///< Allocated number of sections
+    int current;                ///< Index of the section lines are pushed to
+    size_t size;                ///< Number of bytes in sections
+    Buffer_page *page;  ///< Current page, older pages follow
+    Buffer_page *side;  ///< Current page for lines pushed to other than the current section
+    char *line;         ///< Start of the accumulator string in the current page
+    Buffer_node *nodes; ///< Slab nodes are allocated from
+    int nodes_left;     ///< Number of unused nodes in the slab
+    void *slabs;        ///< List of allocated slabs
 } Buffer_ll;
 
 
 // Function prototypes for buffer operations
 bool buf_init(Buffer_ll **buf);
-Buffer_node *buf_new_node();
+Buffer_node *buf_new_node(Buffer_ll *buf);
+int buf_section(Buffer_ll *buf, const char *name);
+int buf_find_section(Buffer_ll *buf, const char *name);
+void buf_select(Buffer_ll *buf, int section);
+bool buf_reserve(Buffer_ll *buf, size_t len);
+size_t buf_line_len(Buffer_ll *buf);
 bool buf_add(Buffer_ll *buf, char *str);
+bool buf_add_len(Buffer_ll *buf, const char *str, size_t len);
 bool buf_push(Buffer_ll *buf);
+bool buf_push_to(Buffer_ll *buf, int section);
 bool buf_add_push(Buffer_ll *buf, char *str);
-void buf_add_flag(Buffer_ll *buf);
-void buf_delete_flag(Buffer_ll *buf);
+size_t buf_format_int(char *out, int num);
+size_t buf_format_float(char *out, double num);
+size_t buf_format_string(char *out, const char *str, size_t len);
 bool buf_add_int(Buffer_ll *buf, int num);
 bool buf_add_float(Buffer_ll *buf, double num);
 bool buf_add_string(Buffer_ll *buf, char *str);
-bool buf_push_after_flag(Buffer_ll *buf);
 bool fprint_buffer(Buffer_ll *buf, FILE *stream);
+bool buf_flush(Buffer_ll *buf, FILE *stream);
+char *buf_to_string(Buffer_ll *buf, int from);
+void buf_free(Buffer_ll *buf);
 
 #endif // CODE_BUFFER_H
 
@@ -13,16 +13,28 @@
 #include <stdbool.h>
 #include "code_buffer.h"
 #include "ast.h"
+#include "error.h"
 
 #define BUFFER buf          // Global buffer for code generation
-#define RETVAL "GF@retval"  // Global variable name for storing the return value of functions in generated code
-#define NIL "nil@nil"       // Represents a nil value in the generated code
+#define CODE body_code      // Instruction stream of the current function body
+#define RETVAL var_operand(FRAME_GF, -1, "retval")     // Global variable for storing the return value of functions in generated code
+#define TMP_BOOL var_operand(FRAME_TF, -1, "tmp_bool") // Variable holding result of conditions
 #define TMP1 "_tmp_1"       // Temporary variable 1 used for generating bin operator ">=" and "<="
 #define TMP2 "_tmp_2"       // Temporary variable 1 used for generating bin operator ">=" and "<="
-#define COMPILER true       // Flag to indicate compiler-defined variables
-#define USER false          // Flag to indicate user-defined variables
+#define CONCAT_TMP "_concat_tmp" // Temporary variable used for generating ifj.concat
 
-Buffer_ll *BUFFER;  // Pointer to the buffer structure for code generation.
+// Slots of compiler-defined variables, relative to the end of user variable slots of the frame
+#define TMP1_SLOT       0
+#define TMP2_SLOT       1
+#define CONCAT_TMP_SLOT 2
+#define ARG_SLOT        3   // slot of "%0", next arguments follow
+#define COMPILER_SLOT(vars, idx) ((vars)->frame_size + (idx))
+
+THREAD_LOCAL Buffer_ll *BUFFER;  // Pointer to the buffer structure for code generation.
+static THREAD_LOCAL Instr_stream CODE;          // Instructions of the function body, printed when the function is finished
+static THREAD_LOCAL Instr_stream prologue_code; // Instructions of the function prologue
+static THREAD_LOCAL int label_count = 0; // count for function genarate_label, labels of a program are numbered in order of generation
+static THREAD_LOCAL Code_stats *stats = NULL;   // Statistics of the generated code, NULL if they are not collected
 
 /**
  * @brief Adds a string to the accumulator string.
@@ -38,351 +50,288 @@ Buffer_ll *BUFFER;  // Pointer to the buffer structure for code generation.
     } while (0)
 
 
-
-/**
- * @brief Adds a string to accumlator string in buffer and insert space charatceter before that string.
- *
- * @param val String to be added
- * @return `false` if the operation fails; otherwise, execution continues.
- *
- */
-#define add_param(val) \
-    do { \
-        if (!buf_add(BUFFER, " ")) { \
-            return false; \
-        } \
-        if (!buf_add(BUFFER, val)) { \
-            return false; \
-        } \
-    } while (0)
-
-
-/**
- * @brief Adds a integer to accumlator string in buffer and insert '%' before that integer.
- *
- * @param int_val The interger to be added
- * @return `false` if the operation fails; otherwise, execution continues.
- *
- */
-#define PARAM(int_val) \
-    do { \
-        if (!buf_add(BUFFER, "%")) { \
-            return false; \
-        } \
-        if (!buf_add_int(BUFFER, int_val)) { \
-            return false; \
-        } \
-    } while (0)
-
-
 /**
- * @brief Adds a string to accumlator string in buffer and insert 'TF@' before that string.
- *
- * @param val String to be added
- * @return `false` if the operation fails; otherwise, execution continues.
- *
- */
-#define TF_ARGS(val) \
-    do { \
-        if (!buf_add(BUFFER, "TF@")) { \
-            return false; \
-        } \
-        if (!buf_add(BUFFER, val)) { \
-            return false; \
-        } \
-    } while (0)
-
-
-/**
- * @brief Adds a string to accumlator string in buffer and insert 'TF@_' before that string.
+ * @brief Adds a newline to accumaltor and pushes accumulator stirng it into the linked list.
  *
- * @param val String to be added
  * @return `false` if the operation fails; otherwise, execution continues.
  *
  */
-#define TF(val) \
+#define endl() \
     do { \
-        if (!buf_add(BUFFER, "TF@_")) { \
-            return false; \
-        } \
-        if (!buf_add(BUFFER, val)) { \
+        if (!buf_add_push(BUFFER, "\n")) { \
             return false; \
         } \
     } while (0)
 
 
 /**
- * @brief Adds a newline to accumaltor and pushes accumulator stirng it into the linked list.
+ * @brief Appends an instruction to an instruction stream.
  *
+ * @param code Pointer to the instruction stream.
+ * @param op Opcode of the instruction.
+ * @param a, b, c Operands of the instruction, no_operand() for unused ones.
  * @return `false` if the operation fails; otherwise, execution continues.
  *
  */
-#define endl() \
+#define emit_to(code, op, a, b, c) \
     do { \
-        if (!buf_add_push(BUFFER, "\n")) { \
+        if (!instr_add(code, op, a, b, c)) { \
             return false; \
         } \
     } while (0)
 
 
 /**
- * @brief Adds a space charatceter to accumulator string.
+ * @brief Appends an instruction with up to three operands to the function body.
  *
  * @return `false` if the operation fails; otherwise, execution continues.
  *
  */
-#define space() \
-    do { \
-        if (!buf_add(BUFFER, " ")) { \
-            return false; \
-        } \
-    } while (0)
+#define emit3(op, a, b, c) emit_to(&CODE, op, a, b, c)
+#define emit2(op, a, b)    emit3(op, a, b, no_operand())
+#define emit1(op, a)       emit3(op, a, no_operand(), no_operand())
+#define emit0(op)          emit3(op, no_operand(), no_operand(), no_operand())
 
 
 /**
- * @brief Initializes a Defined_vars structure.
+ * @brief Initializes a Defined_vars structure for a frame.
  *
- * @param vars Pointer to a Defined_vars structure to be initialized.
+ * @param vars       Pointer to a Defined_vars structure to be initialized.
+ * @param frame_size Number of user variable slots in the frame.
+ * @return true if the structure was successfully initialized, false on failure.
  */
-void inint_def_vars(Defined_vars *vars){
-    vars->names = NULL;
-    vars->num_of_vars = 0;
+bool inint_def_vars(Defined_vars *vars, int frame_size){
+    vars->frame_size = frame_size;
+    vars->capacity   = frame_size + ARG_SLOT + 1;
+    vars->defined    = calloc(vars->capacity, sizeof(bool));
+    return vars->defined != NULL;
 }
 
 
 /**
- * @brief Adds a new variable name to the Defined_vars structure.
+ * @brief Marks a slot in the Defined_vars structure as defined.
  *
  *
  * @param vars Pointer to the Defined_vars structure.
- * @param name Pointer to the string representing the variable name.
+ * @param slot Frame slot of the variable.
  * @return true if the variable was successfully added, false on failure.
  */
-bool add_to_def_vars(Defined_vars *vars, char *name){
-    char **tmp = realloc(vars->names, sizeof(char*)*(vars->num_of_vars+1));
-    if(tmp == NULL) return false;
-
-    vars->names = tmp;
-
-    vars->names[vars->num_of_vars] = malloc(strlen(name) + 1);
-    if (vars->names[vars->num_of_vars] == NULL) {
-        return false; 
+bool add_to_def_vars(Defined_vars *vars, int slot){
+    if(slot >= vars->capacity){
+        int new_capacity = vars->capacity * 2 > slot ? vars->capacity * 2 : slot + 1;
+        bool *tmp = realloc(vars->defined, sizeof(bool) * new_capacity);
+        if(tmp == NULL) return false;
+
+        memset(tmp + vars->capacity, 0, sizeof(bool) * (new_capacity - vars->capacity));
+        vars->defined  = tmp;
+        vars->capacity = new_capacity;
     }
 
-    strcpy(vars->names[vars->num_of_vars], name);
-    vars->num_of_vars++;
-
+    vars->defined[slot] = true;
     return true;
 }
 
 
 /**
- * @brief Adds a new variable name to the Defined_vars structure.
+ * @brief Checks whether a slot in the Defined_vars structure is defined.
  *
  *
  * @param vars Pointer to the Defined_vars structure.
- * @param name Pointer to the string representing the variable name.
- * @return true if the variable was successfully added, false on failure.
+ * @param slot Frame slot of the variable.
+ * @return true if the variable is already defined, false otherwise.
  */
-bool is_in_def_vars(Defined_vars *vars, char *name){
-    for(int i = 0; i<vars->num_of_vars; i++){
-        if(strcmp(vars->names[i], name) == 0) return true;
-    }
-    return false;
+bool is_in_def_vars(Defined_vars *vars, int slot){
+    return slot < vars->capacity && vars->defined[slot];
 }
 
 
 /**
- * @brief Deletes all variable names and frees memory in the Defined_vars structure.
+ * @brief Frees memory in the Defined_vars structure.
  *
  * @param vars Pointer to the Defined_vars structure to be deleted.
  */
 void delete_def_vars(Defined_vars *vars){
-    for(int i = 0; i<vars->num_of_vars; i++){
-        free(vars->names[i]);
-    }
-    free(vars->names);
-    vars->names = NULL;
-    vars->num_of_vars = 0;
-}
-
-/**
- * @brief Add formatted int value to the code buffer.
- * @param val The int value to be added.
- * @return true if the operation was successful, false otherwise.
- */
-bool add_int(int val){
-    add_code("int@");
-    if(!buf_add_int(buf, val)) return false;
-    return true;
-}
-
-/**
- * @brief Add formatted float value to the code buffer.
- * @param val The float value to be added.
- * @return true if the operation was successful, false otherwise.
- */
-bool add_float(double val){
-    add_code("float@");
-    if(!buf_add_float(buf, val)) return false;
-    return true;
-}
-
-/**
- * @brief Add formatted string value to the code buffer.
- * @param str The string value to be added.
- * @return true if the operation was successful, false otherwise.
- */
-bool add_string(char *str){
-    add_code("string@");
-    if(!buf_add_string(buf, str)) return false;
-    return true;
-}
-
-/**
- * @brief Helper function to add a null value in a specific format(nil@nil)
- * @return true Always returns true.
- */
-bool add_null(){
-    add_code("nil@nil");
-    return true;
+    free(vars->defined);
+    vars->defined    = NULL;
+    vars->frame_size = 0;
+    vars->capacity   = 0;
 }
 
 /**
- * @brief Add READ instruction to the code buffer.
+ * @brief Add READ instruction to the function body.
  * @param var The variable which input will be assigned to.
  * @param type Type of variable being read (INT, FLOAT, STRING).
  * @return true if the operation was successful, false otherwise.
  */
-bool add_read(char *var, Types type){
-    add_code("READ");
-    add_param(var);  
+bool add_read(Operand var, Types type){
     switch (type){
     case INT:
-        add_param("int");
+        emit2(OP_READ, var, type_operand("int"));
         break;
     case FLOAT:
-        add_param("float");
+        emit2(OP_READ, var, type_operand("float"));
         break;
     case STRING:
-        add_param("string");
+        emit2(OP_READ, var, type_operand("string"));
     }
-    endl();
     return true;
 }
 
 
 /**
- * @brief Add WRITE instruction to the code buffer.
+ * @brief Add WRITE instruction to the function body.
  * @param term The term (int, float, string, or variable) to be printed.
  * @return true if the operation was successful, false otherwise.
  */
-bool add_write(char *term){
-    add_code("WRITE");
-    add_param(term);
-    endl();
+bool add_write(Operand term){
+    emit1(OP_WRITE, term);
     return true;
 }
 
 
 /**
- * @brief Add INT2FLOAT instruction to the code buffer.
+ * @brief Add INT2FLOAT instruction to the function body.
  * @param var The variable where the conversion result will be assigned.
  * @param symb The symbol (string or variable) from which the conversion is performed.
  * @return true if the operation was successful, false otherwise.
  */
-bool add_i2f(char *var, char *symb){
-    add_code("INT2FLOAT");
-    add_param(var);
-    add_param(symb);
-    endl();
+bool add_i2f(Operand var, Operand symb){
+    emit2(OP_INT2FLOAT, var, symb);
     return true;
 }
 
 
 /**
- * @brief Add FLOAT2INT instruction to the code buffer.
+ * @brief Add FLOAT2INT instruction to the function body.
  * @param var The variable where the conversion result will be assigned.
  * @param symb The symbol (string or variable) from which the conversion is performed.
  * @return true if the operation was successful, false otherwise.
  */
-bool add_f2i(char *var, char *symb){
-    add_code("FLOAT2INT");
-    add_param(var);
-    add_param(symb);
-    endl();
+bool add_f2i(Operand var, Operand symb){
+    emit2(OP_FLOAT2INT, var, symb);
     return true;
 }
 
 
 /**
- * @brief Add STRLEN instruction to the code buffer.
+ * @brief Add STRLEN instruction to the function body.
  * @param var The variable where the result will be assigned.
  * @param symb The symbol (string or variable) whose length will be calculated.
  * @return true if the operation was successful, false otherwise.
  */
-bool add_str_len(char *var, char *symb){
-    add_code("STRLEN");
-    add_param(var);
-    add_param(symb);
-    endl();
+bool add_str_len(Operand var, Operand symb){
+    emit2(OP_STRLEN, var, symb);
     return true;
 }
 
 
 /**
- * @brief Add CONCAT instruction to the code buffer.
+ * @brief Add CONCAT instruction to the function body.
  * @param var The variable where the concatenation result will be assigned.
  * @param symb1 The first symbol to concatenate.
  * @param symb2 The second symbol to concatenate.
  * @return true if the operation was successful, false otherwise.
  */
-bool add_str_concat(char *var, char *symb1, char *symb2){
-    add_code("CONCAT");
-    add_param(var);
-    add_param(symb1);
-    add_param(symb2);
-    endl();
+bool add_str_concat(Operand var, Operand symb1, Operand symb2){
+    emit3(OP_CONCAT, var, symb1, symb2);
     return true;
 }
 
 
 /**
- * @brief Add INT2CHAR instruction to the code buffer.
+ * @brief Add INT2CHAR instruction to the function body.
  * @param var The variable where the character result will be assigned.
  * @param symb The symbol (integer or variable) to be converted to a character.
  * @return true if the operation was successful, false otherwise.
  */
-bool add_chr(char *var, char *symb){
-    add_code("INT2CHAR");
-    add_param(var);
-    add_param(symb);
-    endl();
+bool add_chr(Operand var, Operand symb){
+    emit2(OP_INT2CHAR, var, symb);
     return true;
 }
 
 
+/**
+ * @brief Records a part of the generated code in the statistics.
+ *
+ * @param name Name of the part.
+ * @param type Type of the part.
+ * @param instructions Number of instructions of the part, they are already counted per opcode.
+ * @param bytes Size of the part.
+ * @return true if the operation was successful, false otherwise.
+ */
+static bool stats_add_part(char *name, Code_part_type type, long instructions, size_t bytes){
+    if(stats->part_cnt == stats->part_cap){
+        int new_cap = stats->part_cap == 0 ? 64 : stats->part_cap * 2;
+        Code_part_stats *tmp = realloc(stats->parts, sizeof(Code_part_stats) * new_cap);
+        if(tmp == NULL) return false;
+        stats->parts    = tmp;
+        stats->part_cap = new_cap;
+    }
+    char *copy = malloc(strlen(name) + 1);
+    if(copy == NULL) return false;
+    strcpy(copy, name);
+
+    Code_part_stats *part = &stats->parts[stats->part_cnt++];
+    part->name         = copy;
+    part->type         = type;
+    part->instructions = instructions;
+    part->bytes        = bytes;
+    stats->instructions += instructions;
+    stats->bytes        += bytes;
+    return true;
+}
+
+/**
+ * @brief Adds a part of the code in text form, followed by a newline, to the code buffer.
+ *
+ * @param name Name of the part, used in the statistics.
+ * @param type Type of the part.
+ * @param code Code to be added.
+ * @return true if the operation was successful, false otherwise.
+ */
+static bool add_text(char *name, Code_part_type type, char *code){
+    size_t before = BUFFER->size;
+    add_code(code); endl();
+    if(stats != NULL){
+        return stats_add_part(name, type, instr_count_text(code, stats->opcodes), BUFFER->size - before);
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the flag of a builtin function implemented by a helper routine.
+ * @param name Name of the builtin function.
+ * @return BUILTIN_* flag of the function, 0 if it has no helper routine.
+ */
+int builtin_helper(char *name){
+    if(strcmp(name, "substring") == 0) return BUILTIN_SUBSTRING;
+    if(strcmp(name, "strcmp") == 0)    return BUILTIN_STRCMP;
+    if(strcmp(name, "ord") == 0)       return BUILTIN_ORD;
+    return 0;
+}
+
 /**
  * @brief Generate built-in functions in the code buffer.
+ * @param builtins BUILTIN_* flags of the helper routines to be generated.
  * @return true if the operation was successful, false otherwise.
  */
-bool generate_build_in_functions(){
-    add_code(SUBSTRING);
-    endl();
-    add_code(STRCMP);
-    endl();
-    add_code(ORD);
+bool generate_build_in_functions(int builtins){
+    if((builtins & BUILTIN_SUBSTRING) && !add_text("substring", CODE_PART_BUILTIN, SUBSTRING)) return false;
+    if((builtins & BUILTIN_STRCMP) && !add_text("strcmp", CODE_PART_BUILTIN, STRCMP)) return false;
+    if((builtins & BUILTIN_ORD) && !add_text("ord", CODE_PART_BUILTIN, ORD)) return false;
     return true;
 }
 
 /**
  * @brief Generate the header for the code.
+ * @param builtins BUILTIN_* flags of the helper routines the program calls.
  * @return true if the operation was successful, false otherwise.
  */
-bool generate_header(){
-    add_code(HEADER); endl();
-    if(!generate_build_in_functions()) return false;
-    endl();
+bool generate_header(int builtins){
+    if(buf_section(BUFFER, "header") < 0) return false;
+    if(!add_text("header", CODE_PART_PROGRAM, HEADER)) return false;
+    if(buf_section(BUFFER, "builtins") < 0) return false;
+    if(!generate_build_in_functions(builtins)) return false;
     return true;
 }
 
@@ -391,269 +340,288 @@ bool generate_header(){
  * @return true if the operation was successful, false otherwise.
  */
 bool generate_footer(){
-    add_code("LABEL $$end\n"); endl();
+    if(buf_section(BUFFER, "footer") < 0) return false;
+    if(!add_text("footer", CODE_PART_PROGRAM, "LABEL $$end\n")) return false;
     return true;
 }
 
 
 /**
- * @brief Checks if a variable is defined and defines it if not already defined.
+ * @brief Creates a buffer section for a part of a function, named "function.part".
+ *
+ * @param fun_name Name of the function.
+ * @param part Name of the part.
+ *
+ * @return Index of the section, or -1 if memory allocation fails.
+ */
+static int function_section(char *fun_name, char *part){
+    char *name = malloc(strlen(fun_name) + strlen(part) + 2);
+    if(name == NULL) return -1;
+    sprintf(name, "%s.%s", fun_name, part);
+    int section = buf_section(BUFFER, name);
+    free(name);
+    return section;
+}
+
+/**
+ * @brief Checks if a variable is defined and defines it in the function prologue if not already defined.
  *
  * @param TF_vars Pointer to the Defined_vars structure containing the list of defined variables.
- * @param var_tmp The name of the variable to be checked or defined.
- * @param defined_by_who A boolean flag indicating who is defining the variable (e.g., compiler).
+ * @param slot Frame slot of the variable.
+ * @param var The variable to be checked or defined.
  * 
  * @return true if the operation was successful, false otherwise.
  */
-bool def_var(Defined_vars *TF_vars, char *var_tmp, bool defined_by_who){
-    if(!is_in_def_vars(TF_vars, var_tmp)){
-        add_code("DEFVAR "); 
-        if(defined_by_who == COMPILER){
-            TF_ARGS(var_tmp);
-        }
-        else{
-            TF(var_tmp);
-        }
-        add_code("\n");
-        if(!buf_push_after_flag(BUFFER)) return false;
-        if(!add_to_def_vars(TF_vars, var_tmp)) return false;
+bool def_var(Defined_vars *TF_vars, int slot, Operand var){
+    if(!is_in_def_vars(TF_vars, slot)){
+        emit_to(TF_vars->prologue, OP_DEFVAR, var, no_operand(), no_operand());
+        if(!add_to_def_vars(TF_vars, slot)) return false;
     }   
     return true;
 }
 
 
+/**
+ * @brief Returns the name of a user variable in the frame of the current function.
+ *
+ * @param tree Pointer to the compact AST.
+ * @param TF_vars Pointer to the Defined_vars structure of the current function.
+ * @param slot Frame slot of the variable.
+ *
+ * @return The name of the variable.
+ */
+static char *slot_name(compactAST *tree, Defined_vars *TF_vars, astIdx slot){
+    return compactString(tree, TF_vars->names[slot]);
+}
+
+/**
+ * @brief Operand of a user variable in the frame of the current function.
+ */
+#define USER_VAR(slot) user_var_operand(slot, slot_name(tree, TF_vars, slot))
+
+/**
+ * @brief Operand of a compiler-defined variable in the frame of the current function.
+ */
+#define TMP_VAR(idx, name) var_operand(FRAME_TF, COMPILER_SLOT(TF_vars, idx), name)
+
+
 /**
  * @brief Generates a label based on the specified type and number.
  *
- * @param label A pointer to a string buffer where the generated label will be stored.
  * @param type The type of the label to be generated.
  * @param number A unique number that will be appended to the label to differentiate it.
  *
+ * @return Operand of the label.
  */
-void generate_label(char *label, LABEL_TYPES type, int number){
-    char tmp[15];
-    switch(type){
-        case WHILE_COND:
-            strcpy(tmp, "while-cond");
-            break;
-        case WHILE_END:
-            strcpy(tmp, "while-end");
-            break;
-        case IF_ELSE:
-            strcpy(tmp, "if-else");
-            break;
-        case IF_END:
-            strcpy(tmp, "if-end");
-            break;
-    }
-    sprintf(label, "&%s-%d", tmp, number);
+Operand generate_label(LABEL_TYPES type, int number){
+    static const char *const names[] = {
+        [WHILE_COND] = "while-cond", [WHILE_END] = "while-end", [IF_ELSE] = "if-else", [IF_END] = "if-end"
+    };
+    return label_operand(names[type], number);
 }
 
 
 /**
- * @brief Generates output code from an AST.
+ * @brief Generates output code from a compact AST.
  *
  * This function recursively traverses the provided AST and generates corresponding code.
  *  
- * @param ast Pointer to the root of the AST to be processed.
+ * @param tree Pointer to the compact AST.
+ * @param idx Index of the node to be processed.
  * @param TF_vars Pointer to the structure that holds the defined variables.
  *
  * @return true if the code generation was successful, false if an error occurred.
  */
-bool code_generator(astNode *ast, Defined_vars *TF_vars){
-    static int count = 0;   // count for function genarate_label 
-    if(ast == NULL) return true;
+bool code_generator(compactAST *tree, astIdx idx, Defined_vars *TF_vars){
+    if(idx == AST_NONE) return true;
+    compactNode *ast = &tree->nodes[idx];
 
     // Vars for storing generated lable
-    char cond_label[52];
-    char else_label[52];
-    char end_label[52];
+    Operand cond_label;
+    Operand else_label;
+    Operand end_label;
     switch (ast->type){
         case AST_NODE_WHILE:
-            count++;    // Increment count for generating unique labels for the loop
+            label_count++;    // Increment label_count for generating unique labels for the loop
 
             // Save genrated label names
-            generate_label(cond_label, WHILE_COND, count);
-            generate_label(end_label, WHILE_END, count);
+            cond_label = generate_label(WHILE_COND, label_count);
+            end_label  = generate_label(WHILE_END, label_count);
         
-            add_code("LABEL "); add_code(cond_label); endl(); 
+            emit1(OP_LABEL, cond_label);
 
             // Recursively generate code for the while loop condition
-            if(!code_generator(ast->nodeRep.whileNode.condition, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
 
              // Check if the loop uses a variable with 'null' handling
-            if(ast->nodeRep.whileNode.withNull){
+            if(ast->flags & COMPACT_WITH_NULL){
                 // Define the variable in the temporary frame
-                def_var(TF_vars, ast->nodeRep.whileNode.id_without_null, USER);
+                Operand id_without_null = user_var_operand((int)tree->extra[ast->b + 1], compactString(tree, tree->extra[ast->b + 2]));
+                def_var(TF_vars, tree->extra[ast->b + 1], id_without_null);
 
-                add_code("POPS "); TF(ast->nodeRep.whileNode.id_without_null); endl();
-                add_code("JUMPIFEQ "); add_code(end_label); space(); add_null(); space(); TF(ast->nodeRep.whileNode.id_without_null); endl();
+                emit1(OP_POPS, id_without_null);
+                emit3(OP_JUMPIFEQ, end_label, nil_operand(), id_without_null);
             }
             else{
-                add_code("POPS TF@tmp_bool"); endl();
-                add_code("JUMPIFNEQ "); add_code(end_label); add_code(" TF@tmp_bool bool@true"); endl();
+                emit1(OP_POPS, TMP_BOOL);
+                emit3(OP_JUMPIFNEQ, end_label, TMP_BOOL, bool_operand(true));
             }
 
             
             // Recursively generate code for the body of the while loop
-            if(!code_generator(ast->nodeRep.whileNode.body, TF_vars)) return false;
+            if(!code_generator(tree, tree->extra[ast->b], TF_vars)) return false;
             
             
-            add_code("JUMP "); add_code(cond_label); endl();
-            add_code("LABEL "); add_code(end_label); endl();
+            emit1(OP_JUMP, cond_label);
+            emit1(OP_LABEL, end_label);
 
             // Continue with the next part of the program
-            if(!code_generator(ast->next, TF_vars)) return false;
+            if(!code_generator(tree, ast->next, TF_vars)) return false;
             break;
         case AST_NODE_IFELSE:
-            count++;
+            label_count++;
             // Save genrated label names
-            generate_label(else_label, IF_ELSE, count);
-            generate_label(end_label, IF_END, count);
+            else_label = generate_label(IF_ELSE, label_count);
+            end_label  = generate_label(IF_END, label_count);
 
             // Generate code for the condition expression
-            if(!code_generator(ast->nodeRep.ifElseNode.condition, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
 
             // Check if the if-else condition involves 'null' handling
-            if(ast->nodeRep.ifElseNode.withNull){ 
+            if(ast->flags & COMPACT_WITH_NULL){ 
                 // Define the variable in the temporary frame
-                def_var(TF_vars, ast->nodeRep.ifElseNode.ifPart->nodeRep.ifNode.id_without_null, USER);
+                Operand id_without_null = user_var_operand((int)tree->extra[ast->b + 2], compactString(tree, tree->extra[ast->b + 3]));
+                def_var(TF_vars, tree->extra[ast->b + 2], id_without_null);
 
-                add_code("POPS "); TF(ast->nodeRep.ifElseNode.ifPart->nodeRep.ifNode.id_without_null); endl();
-                add_code("JUMPIFEQ "); add_code(else_label); space(); add_null(); space(); TF(ast->nodeRep.ifElseNode.ifPart->nodeRep.ifNode.id_without_null); endl();
+                emit1(OP_POPS, id_without_null);
+                emit3(OP_JUMPIFEQ, else_label, nil_operand(), id_without_null);
             }
             else{
-                add_code("POPS TF@tmp_bool"); endl();
-                add_code("JUMPIFNEQ "); add_code(else_label); add_code(" TF@tmp_bool bool@true"); endl();
+                emit1(OP_POPS, TMP_BOOL);
+                emit3(OP_JUMPIFNEQ, else_label, TMP_BOOL, bool_operand(true));
             }
 
             // Generate code for the 'if' part of the statement
-            if(!code_generator(ast->nodeRep.ifElseNode.ifPart, TF_vars)) return false;
-            add_code("JUMP "); add_code(end_label); endl();
-            add_code("LABEL "); add_code(else_label); endl();
+            if(!code_generator(tree, tree->extra[ast->b], TF_vars)) return false;
+            emit1(OP_JUMP, end_label);
+            emit1(OP_LABEL, else_label);
 
              // Generate code for the 'else' part of the statement
-            if(!code_generator(ast->nodeRep.ifElseNode.elsePart, TF_vars)) return false;
-            add_code("LABEL "); add_code(end_label); endl();
+            if(!code_generator(tree, tree->extra[ast->b + 1], TF_vars)) return false;
+            emit1(OP_LABEL, end_label);
             
             // Continue with the next part of the program
-            if(!code_generator(ast->next, TF_vars)) return false;
+            if(!code_generator(tree, ast->next, TF_vars)) return false;
 
             break;
-        case AST_NODE_IF:
-            // Procecess the if body
-            if(!code_generator(ast->nodeRep.ifNode.body, TF_vars)) return false;
-            break;
-        
-        case AST_NODE_ELSE:
-            // Procecess the else body
-            if(!code_generator(ast->nodeRep.elseNode.body, TF_vars)) return false;
-            break;
-        
         case AST_NODE_ASSIGN:
             // Expresion evaluation
-            if(!code_generator(ast->nodeRep.assignNode.expression, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
 
             // Assign result to var
-            add_code("POPS "); TF(ast->nodeRep.assignNode.id); endl();
+            emit1(OP_POPS, USER_VAR(ast->b));
 
             // Continue with the next part of the program
-            if(!code_generator(ast->next, TF_vars)) return false;
+            if(!code_generator(tree, ast->next, TF_vars)) return false;
             break;
         
         case AST_NODE_EXPR:
             // Expresion evaluation
-            if(!code_generator(ast->nodeRep.exprNode.exprTree, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
 
-            if(ast->nodeRep.exprNode.exprTree != NULL){
+            if(ast->a != AST_NONE){
                 // Check if the expression is a function call
-                if(ast->nodeRep.exprNode.exprTree->type == AST_NODE_FUNC_CALL){
-                    add_code("PUSHS"); add_param(RETVAL); endl();
+                if(tree->nodes[ast->a].type == AST_NODE_FUNC_CALL){
+                    emit1(OP_PUSHS, RETVAL);
                 }
             }
             break;
         
         case AST_NODE_BINOP:
             // Check if left operand is function call, if so push the return value to data stack
-            if(!code_generator(ast->nodeRep.binOpNode.left, TF_vars)) return false;
-            if(ast->nodeRep.binOpNode.left != NULL && ast->nodeRep.binOpNode.left->type == AST_NODE_FUNC_CALL){
-                add_code("PUSHS"); add_param(RETVAL); endl();
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
+            if(ast->a != AST_NONE && tree->nodes[ast->a].type == AST_NODE_FUNC_CALL){
+                emit1(OP_PUSHS, RETVAL);
             }
 
             // Check if right operand is function call, if so push the return value to data stack
-            if(!code_generator(ast->nodeRep.binOpNode.right, TF_vars)) return false;
-            if(ast->nodeRep.binOpNode.right != NULL && ast->nodeRep.binOpNode.right->type == AST_NODE_FUNC_CALL){
-                add_code("PUSHS"); add_param(RETVAL); endl();
+            if(!code_generator(tree, ast->b, TF_vars)) return false;
+            if(ast->b != AST_NONE && tree->nodes[ast->b].type == AST_NODE_FUNC_CALL){
+                emit1(OP_PUSHS, RETVAL);
             }
 
             // Handle binary operations based on the operator type in the AST node
             // Each case corresponds to a different binary operation
-            switch (ast->nodeRep.binOpNode.op){
+            switch (ast->op){
             case MULTIPLICATION:
-                add_code("MULS"); endl();
+                emit0(OP_MULS);
                 break;
             case DIVISION:
                 // Check data type for integer or float division
-                if(ast->nodeRep.binOpNode.dataT == i32){
-                    add_code("IDIVS"); endl();
+                if(ast->dataT == i32){
+                    emit0(OP_IDIVS);
                 }
                 else{
-                    add_code("DIVS"); endl();
+                    emit0(OP_DIVS);
+                }
+                // Implicit conversion of the result, operands keep their type
+                if(ast->flags & COMPACT_CONVERT){
+                    emit0(ast->dataT == i32 ? OP_INT2FLOATS : OP_FLOAT2INTS);
                 }
                 break;
 
             case ADDITION:
-                add_code("ADDS"); endl();
+                emit0(OP_ADDS);
                 break;
             case SUBSTRACTION:
-                add_code("SUBS"); endl();
+                emit0(OP_SUBS);
                 break;
             case EQUAL:
-                add_code("EQS");endl();
+                emit0(OP_EQS);
                 break;
             case NOT_EQUAL:
-                add_code("EQS");endl();
-                add_code("NOTS");endl();
+                emit0(OP_EQS);
+                emit0(OP_NOTS);
                 break;
             case LOWER:
-                add_code("LTS");endl();
+                emit0(OP_LTS);
                 break;
             case GREATER:
-                add_code("GTS");endl();
+                emit0(OP_GTS);
                 break;
             case LOWER_OR_EQUAL:
                 // Handle <= comparison by combining LTS and EQS
-                if(!def_var(TF_vars, TMP1, COMPILER)) return false;
-                if(!def_var(TF_vars, TMP2, COMPILER)) return false;
-                add_code("POPS "); TF_ARGS(TMP2); endl();
-                add_code("POPS "); TF_ARGS(TMP1); endl();
-
-                add_code("PUSHS "); TF_ARGS(TMP1); endl();
-                add_code("PUSHS "); TF_ARGS(TMP2); endl();
-                add_code("LTS");endl();     // Check if tmp_2 < tmp_1
-
-                add_code("PUSHS "); TF_ARGS(TMP1); endl();
-                add_code("PUSHS "); TF_ARGS(TMP2); endl();
-                add_code("EQS");endl();  // Check if tmp_2 == tmp_1
+                if(!def_var(TF_vars, COMPILER_SLOT(TF_vars, TMP1_SLOT), TMP_VAR(TMP1_SLOT, TMP1))) return false;
+                if(!def_var(TF_vars, COMPILER_SLOT(TF_vars, TMP2_SLOT), TMP_VAR(TMP2_SLOT, TMP2))) return false;
+                emit1(OP_POPS, TMP_VAR(TMP2_SLOT, TMP2));
+                emit1(OP_POPS, TMP_VAR(TMP1_SLOT, TMP1));
+
+                emit1(OP_PUSHS, TMP_VAR(TMP1_SLOT, TMP1));
+                emit1(OP_PUSHS, TMP_VAR(TMP2_SLOT, TMP2));
+                emit0(OP_LTS);     // Check if tmp_2 < tmp_1
+
+                emit1(OP_PUSHS, TMP_VAR(TMP1_SLOT, TMP1));
+                emit1(OP_PUSHS, TMP_VAR(TMP2_SLOT, TMP2));
+                emit0(OP_EQS);  // Check if tmp_2 == tmp_1
                 
-                add_code("ORS");endl(); // Combine LTS and EQS results                            
+                emit0(OP_ORS); // Combine LTS and EQS results                            
                 break;
             case GREATER_OR_EQUAL:
                 // Handle >= comparison by combining GTS and EQS
-                if(!def_var(TF_vars, TMP1, COMPILER)) return false;
-                if(!def_var(TF_vars, TMP2, COMPILER)) return false;
-                add_code("POPS "); TF_ARGS(TMP2); endl();
-                add_code("POPS "); TF_ARGS(TMP1); endl();
+                if(!def_var(TF_vars, COMPILER_SLOT(TF_vars, TMP1_SLOT), TMP_VAR(TMP1_SLOT, TMP1))) return false;
+                if(!def_var(TF_vars, COMPILER_SLOT(TF_vars, TMP2_SLOT), TMP_VAR(TMP2_SLOT, TMP2))) return false;
+                emit1(OP_POPS, TMP_VAR(TMP2_SLOT, TMP2));
+                emit1(OP_POPS, TMP_VAR(TMP1_SLOT, TMP1));
 
-                add_code("PUSHS "); TF_ARGS(TMP1); endl();
-                add_code("PUSHS "); TF_ARGS(TMP2); endl();
-                add_code("GTS");endl();     // Check if tmp_2 > tmp_1
+                emit1(OP_PUSHS, TMP_VAR(TMP1_SLOT, TMP1));
+                emit1(OP_PUSHS, TMP_VAR(TMP2_SLOT, TMP2));
+                emit0(OP_GTS);     // Check if tmp_2 > tmp_1
 
-                add_code("PUSHS "); TF_ARGS(TMP1); endl();
-                add_code("PUSHS "); TF_ARGS(TMP2); endl();
-                add_code("EQS");endl();     // Check if tmp_2 == tmp_1
+                emit1(OP_PUSHS, TMP_VAR(TMP1_SLOT, TMP1));
+                emit1(OP_PUSHS, TMP_VAR(TMP2_SLOT, TMP2));
+                emit0(OP_EQS);     // Check if tmp_2 == tmp_1
 
-                add_code("ORS");endl();      // Combine GTS and EQS results
+                emit0(OP_ORS);      // Combine GTS and EQS results
                 break;
             default:
                 //code
@@ -664,103 +632,123 @@ bool code_generator(astNode *ast, Defined_vars *TF_vars){
         case AST_NODE_LITERAL:
             // Handle literal nodes in the AST
             // Pushes the literal value onto the stack in correct format based on it's type
-            add_code("PUSHS ");
-            switch(ast->nodeRep.literalNode.dataT){
+            switch(ast->dataT){
             case u8:
             case string:
-                if(!add_string(ast->nodeRep.literalNode.value.charData)) return false;
+                emit1(OP_PUSHS, string_operand(compactString(tree, ast->a)));
                 break;
-            case i32:
-                if(!add_int(ast->nodeRep.literalNode.value.intData)) return false;
+            case i32: {
+                int int_val;
+                memcpy(&int_val, &ast->a, sizeof(int_val));
+                emit1(OP_PUSHS, int_operand(int_val));
                 break;
-            case f64:
-                if(!add_float(ast->nodeRep.literalNode.value.floatData)) return false;
+            }
+            case f64: {
+                astIdx halves[2] = {ast->a, ast->b};
+                double float_val;
+                memcpy(&float_val, halves, sizeof(float_val));
+                emit1(OP_PUSHS, float_operand(float_val));
                 break;
+            }
             case null_:
-                if(!add_null()) return false;
+                emit1(OP_PUSHS, nil_operand());
                 break;
             default:
                 break;
             }
-    
-            endl();
             break;
         
 
         case AST_NODE_VAR:
             // Handle variable nodes in the AST
             // Pushes the variable's value onto the stack based on its var id
-            add_code("PUSHS ");
-            TF(ast->nodeRep.varNode.id); endl();
+            emit1(OP_PUSHS, USER_VAR(ast->a));
             break;
 
 
         case AST_NODE_DEFVAR:
             // Handle variable definition nodes in the AST
             // Defines a variable if not already defined and generates code to initialize it
-            ;
-            char *name = ast->nodeRep.defVarNode.id;
             // Define the variable in the temporary frame if not yet defined
-            if(!def_var(TF_vars, name, USER)) return false;
+            if(!def_var(TF_vars, ast->b, USER_VAR(ast->b))) return false;
 
             // Evaluate assigning expression
-            if(!code_generator(ast->nodeRep.exprNode.exprTree, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
 
             //Asign the result after evaulation
-            add_code("POPS "); TF(name); endl();
+            emit1(OP_POPS, USER_VAR(ast->b));
 
-            if(!code_generator(ast->next, TF_vars)) return false;
+            if(!code_generator(tree, ast->next, TF_vars)) return false;
             break;
         
 
         case AST_UNUSED:
             // Hadnle expression which isn't assign to anything
             // Just evaluate the expresion
-            if(!code_generator(ast->nodeRep.unusedNode.expr, TF_vars)) return false;
-            if(!code_generator(ast->next, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
+            if(!code_generator(tree, ast->next, TF_vars)) return false;
             break;
         
         case AST_NODE_DEFFUNC:
             // Handle fucntion definition node in AST
+            ;
+            astIdx *fun_data  = &tree->extra[ast->b];   // name, paramNum, frameSize, returnType, slot names
+            char   *fun_name  = compactString(tree, fun_data[0]);
+
+            // Prologue is a stream of its own, DEFVARs found in the body are appended to it
+            instr_clear(&prologue_code);
+            instr_clear(&CODE);
+            TF_vars->prologue = &prologue_code;
 
             // Generating label, based on name of function
-            add_code("LABEL "); add_code("$"); add_code(ast->nodeRep.defFuncNode.id); endl();
+            emit_to(TF_vars->prologue, OP_LABEL, func_operand(fun_name), no_operand(), no_operand());
 
             // Push old frame, unless it's the 'main' function
-            if(strcmp(ast->nodeRep.defFuncNode.id, "main") != 0){
-                add_code("PUSHFRAME"); endl();
+            if(strcmp(fun_name, "main") != 0){
+                emit_to(TF_vars->prologue, OP_PUSHFRAME, no_operand(), no_operand(), no_operand());
             }
 
-            add_code("CREATEFRAME"); endl();
-            add_code("DEFVAR TF@tmp_bool");endl();
+            emit_to(TF_vars->prologue, OP_CREATEFRAME, no_operand(), no_operand(), no_operand());
+            emit_to(TF_vars->prologue, OP_DEFVAR, TMP_BOOL, no_operand(), no_operand());
+
+            if(!inint_def_vars(TF_vars, fun_data[2])) return false;
+            TF_vars->names = fun_data + 4;
 
             // Loop over the parameters of the function and define them in the temporary frame (TF).
-            for(int i = 0; i < ast->nodeRep.defFuncNode.paramNum; i++){
-                char *name_ = ast->nodeRep.defFuncNode.paramNames[i];
-                if(!add_to_def_vars(TF_vars, name_)) return false;
+            // Parameters occupy the first slots of the frame.
+            for(int i = 0; i < (int)fun_data[1]; i++){
+                if(!add_to_def_vars(TF_vars, i)) return false;
 
-                add_code("DEFVAR "); TF(name_); endl();
-                add_code("MOVE "); TF(name_); space(); add_code("LF@"); PARAM(i); endl();
+                emit_to(TF_vars->prologue, OP_DEFVAR, USER_VAR(i), no_operand(), no_operand());
+                emit_to(TF_vars->prologue, OP_MOVE, USER_VAR(i), arg_operand(FRAME_LF, i), no_operand());
             }
 
-            // Create flag for var definition
-            buf_add_flag(BUFFER);
-
             // Generate body
-            if(!code_generator(ast->nodeRep.defFuncNode.body, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
 
             // Special case for the 'main' function: it jumps to an 'end' label
-            if(strcmp(ast->nodeRep.defFuncNode.id, "main") == 0){
-                add_code("JUMP $$end"); endl();
+            if(strcmp(fun_name, "main") == 0){
+                emit1(OP_JUMP, internal_operand("end"));
             }
             // For other functions pop the frame and return from the function
-            else if(ast->nodeRep.defFuncNode.returnType == void_){
-                add_code("POPFRAME"); endl();
-                add_code("RETURN"); endl();
+            else if(fun_data[3] == void_){
+                emit0(OP_POPFRAME);
+                emit0(OP_RETURN);
             }
 
+            // Prologue and body are printed to sections of their own
+            size_t before = BUFFER->size;
+            if(function_section(fun_name, "prologue") < 0) return false;
+            if(!instr_print(BUFFER, TF_vars->prologue)) return false;
+            if(function_section(fun_name, "body") < 0) return false;
+            if(!instr_print(BUFFER, &CODE)) return false;
             endl();
 
+            if(stats != NULL){
+                long instructions = instr_count(TF_vars->prologue, stats->opcodes) + instr_count(&CODE, stats->opcodes);
+                if(!stats_add_part(fun_name, CODE_PART_FUNCTION, instructions, BUFFER->size - before)) return false;
+            }
+
             // Clean up the defined variables
             delete_def_vars(TF_vars);
             break;
@@ -769,112 +757,110 @@ bool code_generator(astNode *ast, Defined_vars *TF_vars){
             // Handle return node in AST
 
             // Generate code for the return expression, if present
-            if(!code_generator(ast->nodeRep.returnNode.returnExp, TF_vars)) return false;
+            if(!code_generator(tree, ast->a, TF_vars)) return false;
 
             // If the return type is not 'void', pop the return value into RETVAL
-            if(ast->nodeRep.returnNode.returnType != void_){
-                add_code("POPS"); add_param(RETVAL); endl();
+            if(ast->dataT != void_){
+                emit1(OP_POPS, RETVAL);
             }
 
             // If this return is in the 'main' function, jump to end of the program
-            if(ast->nodeRep.returnNode.inMain){
-                add_code("JUMP $$end"); endl();
+            if(ast->flags & COMPACT_IN_MAIN){
+                emit1(OP_JUMP, internal_operand("end"));
             }
              // For other functions, pop the frame and return
             else{
-                add_code("POPFRAME"); endl();
-                add_code("RETURN"); endl();
+                emit0(OP_POPFRAME);
+                emit0(OP_RETURN);
             }
             break;
         
         case AST_NODE_ROOT:
             // Continue generating code for the next node in the AST.
-            return code_generator(ast->next, TF_vars);
+            return code_generator(tree, ast->next, TF_vars);
             break;
 
         case AST_NODE_FUNC_CALL:
             // Handle function call node in AST
-
-
-            if(    ast->nodeRep.funcCallNode.builtin 
-                && (strcmp(ast->nodeRep.funcCallNode.id, "substring") != 0)
-                && (strcmp(ast->nodeRep.funcCallNode.id, "strcmp") != 0)
-                && (strcmp(ast->nodeRep.funcCallNode.id, "ord") != 0)
+            ;
+            char   *call_id   = compactString(tree, ast->a);
+            int     param_num = tree->extra[ast->b];
+            astIdx *params    = &tree->extra[ast->b + 1];
+
+            if(    (ast->flags & COMPACT_BUILTIN) 
+                && (strcmp(call_id, "substring") != 0)
+                && (strcmp(call_id, "strcmp") != 0)
+                && (strcmp(call_id, "ord") != 0)
             ){
                 // Handle built-in functions
                 // Each built-in function is processed differently depending on its type
-                if(strcmp(ast->nodeRep.funcCallNode.id, "readstr") == 0){
+                if(strcmp(call_id, "readstr") == 0){
                     if(!add_read(RETVAL, STRING)) return false;
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "readi32") == 0){
+                else if(strcmp(call_id, "readi32") == 0){
                     if(!add_read(RETVAL, INT)) return false;
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "readf64") == 0){
+                else if(strcmp(call_id, "readf64") == 0){
                     if(!add_read(RETVAL, FLOAT)) return false;
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "write") == 0){
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[0], TF_vars)) return false;
-                    add_code("POPS"); add_param(RETVAL); endl();
+                else if(strcmp(call_id, "write") == 0){
+                    if(!code_generator(tree, params[0], TF_vars)) return false;
+                    emit1(OP_POPS, RETVAL);
                     if(!add_write(RETVAL)) return false;
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "i2f") == 0){
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[0], TF_vars)) return false;
-                    add_code("POPS"); add_param(RETVAL); endl();
+                else if(strcmp(call_id, "i2f") == 0){
+                    if(!code_generator(tree, params[0], TF_vars)) return false;
+                    emit1(OP_POPS, RETVAL);
                     if(!add_i2f(RETVAL, RETVAL)) return false;
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "f2i") == 0){
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[0], TF_vars)) return false;
-                    add_code("POPS"); add_param(RETVAL); endl();
+                else if(strcmp(call_id, "f2i") == 0){
+                    if(!code_generator(tree, params[0], TF_vars)) return false;
+                    emit1(OP_POPS, RETVAL);
                     if(!add_f2i(RETVAL, RETVAL)) return false;
                 }
-                 else if(strcmp(ast->nodeRep.funcCallNode.id, "string") == 0){
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[0], TF_vars)) return false;
-                    add_code("POPS"); add_param(RETVAL); endl();
+                 else if(strcmp(call_id, "string") == 0){
+                    if(!code_generator(tree, params[0], TF_vars)) return false;
+                    emit1(OP_POPS, RETVAL);
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "length") == 0){
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[0], TF_vars)) return false;
-                    add_code("POPS"); add_param(RETVAL); endl();
+                else if(strcmp(call_id, "length") == 0){
+                    if(!code_generator(tree, params[0], TF_vars)) return false;
+                    emit1(OP_POPS, RETVAL);
                     if(!add_str_len(RETVAL, RETVAL)) return false;
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "concat") == 0){
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[0], TF_vars)) return false;
+                else if(strcmp(call_id, "concat") == 0){
+                    if(!code_generator(tree, params[0], TF_vars)) return false;
                     
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[1], TF_vars)) return false;
+                    if(!code_generator(tree, params[1], TF_vars)) return false;
                     
-                    char var_tmp[] = "_concat_tmp";
                     // define var if it is not defined on begining
-                    if(!def_var(TF_vars,var_tmp, COMPILER)) return false;
+                    if(!def_var(TF_vars, COMPILER_SLOT(TF_vars, CONCAT_TMP_SLOT), TMP_VAR(CONCAT_TMP_SLOT, CONCAT_TMP))) return false;
 
-                    add_code("POPS"); add_param(RETVAL); endl();
-                    add_code("POPS "); TF_ARGS(var_tmp); endl();
+                    emit1(OP_POPS, RETVAL);
+                    emit1(OP_POPS, TMP_VAR(CONCAT_TMP_SLOT, CONCAT_TMP));
 
-                    add_code("CONCAT"); add_param(RETVAL); space(); TF_ARGS(var_tmp); add_param(RETVAL); endl();
+                    if(!add_str_concat(RETVAL, TMP_VAR(CONCAT_TMP_SLOT, CONCAT_TMP), RETVAL)) return false;
                 }
-                else if(strcmp(ast->nodeRep.funcCallNode.id, "chr") == 0){
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[0], TF_vars)) return false;
-                    add_code("POPS"); add_param(RETVAL); endl();
+                else if(strcmp(call_id, "chr") == 0){
+                    if(!code_generator(tree, params[0], TF_vars)) return false;
+                    emit1(OP_POPS, RETVAL);
                     if(!add_chr(RETVAL, RETVAL)) return false;
                 }
             }   
             else{
                 // For other functions generate code for each parameter
-                for(int i = 0; i < ast->nodeRep.funcCallNode.paramNum; i++){
-                    char var_tmp[30];
-                    sprintf(var_tmp, "%%%d", i);
+                for(int i = 0; i < param_num; i++){
                     // define var if it is not defined on begining
-                    if(!def_var(TF_vars, var_tmp, COMPILER)) return false;
+                    if(!def_var(TF_vars, COMPILER_SLOT(TF_vars, ARG_SLOT + i), arg_operand(FRAME_TF, i))) return false;
 
-                    if(!code_generator(ast->nodeRep.funcCallNode.paramExpr[i], TF_vars)) return false;
-                    add_code("POPS "); TF_ARGS(var_tmp); endl();
+                    if(!code_generator(tree, params[i], TF_vars)) return false;
+                    emit1(OP_POPS, arg_operand(FRAME_TF, i));
                 }
 
-                // Call the function with the specified parameters
-                add_code("CALL $");
-                if(ast->nodeRep.funcCallNode.builtin) add_code("$");        // adding second $, because builin functions have $$ before name
-                add_code(ast->nodeRep.funcCallNode.id);endl();
+                // Call the function with the specified parameters, builtin functions have $$ before name
+                emit1(OP_CALL, (ast->flags & COMPACT_BUILTIN) ? internal_operand(call_id) : func_operand(call_id));
             }
             // Continue processing the next node in the AST
-            if(!code_generator(ast->next, TF_vars)) return false;
+            if(!code_generator(tree, ast->next, TF_vars)) return false;
             break;
         
         case AST_INVALID:
@@ -886,29 +872,348 @@ bool code_generator(astNode *ast, Defined_vars *TF_vars){
     return true;
 }
 
-bool generate_code(astNode *ast){
-    // Initialize the buffer where generated code will be stored
+
+/**
+ * @brief Starts generation of a new program, generates the header.
+ *
+ * @param builtins BUILTIN_* flags of the helper routines called by functions of the program.
+ *
+ * @return true if the operation was successful, false otherwise.
+ */
+bool generate_begin(int builtins){
+    // Initialize the buffer where generated code will be stored, buffer of a failed generation is dropped
+    buf_free(BUFFER);
+    instr_free(&CODE);
+    instr_free(&prologue_code);
     if(!buf_init(&BUFFER)) return false;
+    label_count = 0;
+    return generate_header(builtins);
+}
 
+/**
+ * @brief Generates code of one function definition.
+ *
+ * @param tree Pointer to the compact AST.
+ * @param fun Index of the function definition node.
+ * @param code If not NULL, allocated copy of the generated code of the function is stored here.
+ *
+ * @return true if the operation was successful, false otherwise.
+ */
+bool generate_function(compactAST *tree, astIdx fun, char **code){
     // Initialize the structure to hold the defined variables
-    Defined_vars var_def;
-    inint_def_vars(&var_def);
+    Defined_vars var_def = {.defined = NULL, .names = NULL, .frame_size = 0, .capacity = 0, .prologue = NULL};
+    int          from    = BUFFER->section_cnt; // sections of the function follow
 
+    if(!code_generator(tree, fun, &var_def)) return false;
 
-    if(!generate_header()) return false;
-    
-    // Move to the first actual node in the AST, noot the root
-    ast = ast->next;
+    if(code != NULL){
+        *code = buf_to_string(BUFFER, from);
+        if(*code == NULL) return false;
+    }
+    return true;
+}
 
-    // Iterate through each AST function nodes
-    while(ast != NULL){
-        if(!code_generator(ast, &var_def)) return false;
-        ast = ast->next;
+/**
+ * @brief Adds code of a function generated earlier by generate_function().
+ *
+ * @param name Name of the function, its code is added as a section of this name.
+ * @param code Code of the function.
+ * @param labels Number of labels the function uses, they have to be numbered as when it was generated.
+ *
+ * @return true if the operation was successful, false otherwise.
+ */
+bool generate_splice(char *name, char *code, int labels){
+    if(buf_section(BUFFER, name) < 0) return false;
+    size_t before = BUFFER->size;
+    add_code(code);
+    if(!buf_push(BUFFER)) return false;
+    label_count += labels;
+    if(stats != NULL){
+        return stats_add_part(name, CODE_PART_FUNCTION, instr_count_text(code, stats->opcodes), BUFFER->size - before);
     }
+    return true;
+}
 
+/**
+ * @brief Returns the number of labels generated so far, labels of the next function are numbered after it.
+ */
+int generated_labels(){
+    return label_count;
+}
+
+/**
+ * @brief Finishes generation of the program and prints it to a stream.
+ *
+ * @param out Stream the generated code is printed to.
+ *
+ * @return true if the operation was successful, false otherwise.
+ */
+bool generate_end(FILE *out){
     if(!generate_footer()) return false;
-    fprint_buffer(BUFFER, stdout);  // Output the generated code from the buffer
-    return true;
+    bool ok = fprint_buffer(BUFFER, out);  // Output the generated code from the buffer
+    buf_free(BUFFER);
+    BUFFER = NULL;
+    instr_free(&CODE);
+    instr_free(&prologue_code);
+    return ok;
+}
+
+/**
+ * @brief Pairs a function with its name, for finding functions by name.
+ */
+typedef struct{
+    char *name;
+    int   fun;  // index of the function in order of definition
+} Fun_name;
+
+static int compare_fun_names(const void *a, const void *b){
+    return strcmp(((const Fun_name *)a)->name, ((const Fun_name *)b)->name);
+}
+
+/**
+ * @brief Finds functions reachable from main by calls and builtin helper routines they call.
+ *
+ *        Nodes of a function follow its definition node in the compact AST, so calls are
+ *        assigned to functions in one pass over all nodes. Definition nodes are checked to come
+ *        in order of the list of functions and called functions are looked up by name in that list,
+ *        a call of a function which is not defined is an internal error. If there is no main,
+ *        all functions are reachable.
+ *
+ * @param tree Pointer to the compact AST.
+ * @param fun_cnt Number of functions.
+ * @param reachable reachable[i] is set to true if the i-th defined function is reachable.
+ * @param builtins BUILTIN_* flags of the helper routines called by reachable functions are stored here.
+ *
+ * @return true if the operation was successful, false if memory allocation fails or the tree is inconsistent.
+ */
+static bool find_reachable(compactAST *tree, int fun_cnt, bool *reachable, int *builtins){
+    Fun_name *names   = malloc(sizeof(Fun_name) * (fun_cnt + 1));
+    int      *helpers = calloc(fun_cnt + 1, sizeof(int));   // helper routines called by each function
+    int      *first   = calloc(fun_cnt + 2, sizeof(int));   // calls of function i are callees[first[i]] .. callees[first[i + 1] - 1]
+    int      *stack   = malloc(sizeof(int) * (fun_cnt + 1));
+    int      *callees = NULL;
+    bool      ok      = names != NULL && helpers != NULL && first != NULL && stack != NULL;
+
+    // Names of the defined functions
+    int fun = 0;
+    for(astIdx def = tree->first; ok && def != AST_NONE; def = tree->nodes[def].next, fun++){
+        names[fun].name = compactString(tree, tree->extra[tree->nodes[def].b]);
+        names[fun].fun  = fun;
+    }
+
+    // Helper routines of functions and numbers of their calls
+    fun = -1;
+    astIdx next_def = tree->first;
+    bool   in_order = true;  // otherwise nodes would be assigned to another function
+    for(astIdx i = 0; ok && in_order && i < tree->nodeCnt; i++){
+        compactNode *node = &tree->nodes[i];
+        if(node->type == AST_NODE_DEFFUNC){
+            in_order = i == next_def;
+            next_def = node->next;
+            fun++;
+        }
+        else if(node->type == AST_NODE_FUNC_CALL){
+            in_order = fun >= 0;
+            if(in_order && (node->flags & COMPACT_BUILTIN)){
+                helpers[fun] |= builtin_helper(compactString(tree, node->a));
+            }
+            else if(in_order){
+                first[fun + 1]++;
+            }
+        }
+    }
+    if(ok && (!in_order || next_def != AST_NONE)){
+        fprintf(ERROR_OUTPUT, "\nERROR NUMBER %d: Nodes of functions are not in order of their definitions\n", ERR_INTERNAL);
+        ok = false;
+    }
+    for(int i = 0; ok && i < fun_cnt; i++){
+        first[i + 1] += first[i];
+    }
+    if(ok){
+        qsort(names, fun_cnt, sizeof(Fun_name), compare_fun_names);
+        callees = malloc(sizeof(int) * (first[fun_cnt] + 1));
+        ok = callees != NULL;
+    }
+
+    // Called functions, first[i] is moved to the end of calls of function i
+    fun = -1;
+    for(astIdx i = 0; ok && i < tree->nodeCnt; i++){
+        compactNode *node = &tree->nodes[i];
+        if(node->type == AST_NODE_DEFFUNC){
+            fun++;
+        }
+        else if(node->type == AST_NODE_FUNC_CALL && !(node->flags & COMPACT_BUILTIN)){
+            Fun_name  key    = {.name = compactString(tree, node->a)};
+            Fun_name *callee = bsearch(&key, names, fun_cnt, sizeof(Fun_name), compare_fun_names);
+            if(callee == NULL){
+                fprintf(ERROR_OUTPUT, "\nERROR NUMBER %d: Call of function %s, which is not defined\n", ERR_INTERNAL, key.name);
+                ok = false;
+            }
+            else{
+                callees[first[fun]++] = callee->fun;
+            }
+        }
+    }
+    for(int i = fun_cnt; ok && i > 0; i--){
+        first[i] = first[i - 1];
+    }
+    if(ok){
+        first[0] = 0;
+    }
+
+    // Depth-first search from main
+    Fun_name  key       = {.name = "main"};
+    Fun_name *main_fun  = ok ? bsearch(&key, names, fun_cnt, sizeof(Fun_name), compare_fun_names) : NULL;
+    int       stack_top = 0;
+    *builtins = 0;
+    for(int i = 0; i < fun_cnt; i++){
+        reachable[i] = main_fun == NULL;
+        if(main_fun == NULL && helpers != NULL){
+            *builtins |= helpers[i];
+        }
+    }
+    if(main_fun != NULL){
+        reachable[main_fun->fun] = true;
+        stack[stack_top++]       = main_fun->fun;
+    }
+    while(stack_top > 0){
+        int caller = stack[--stack_top];
+        *builtins |= helpers[caller];
+        for(int i = first[caller]; i < first[caller + 1]; i++){
+            if(!reachable[callees[i]]){
+                reachable[callees[i]] = true;
+                stack[stack_top++]    = callees[i];
+            }
+        }
+    }
+
+    free(names);
+    free(helpers);
+    free(first);
+    free(stack);
+    free(callees);
+    return ok;
+}
+
+/**
+ * @brief Generates output code for all functions of a compact AST and prints it to a stream.
+ *
+ *        Only functions reachable from main and builtin helper routines called by them are generated.
+ *        Output is streamed, code of finished functions is printed whenever BUF_FLUSH_SIZE
+ *        bytes are buffered, so memory of the buffer is bounded by that plus the biggest function.
+ *
+ * @param tree Pointer to the compact AST, either built by buildCompactAST() or mapped by loadASTFile().
+ * @param out Stream the generated code is printed to.
+ *
+ * @return true if the operation was successful, false otherwise.
+ */
+bool generate_code(compactAST *tree, FILE *out){
+    int fun_cnt = 0;
+    for(astIdx fun = tree->first; fun != AST_NONE; fun = tree->nodes[fun].next){
+        fun_cnt++;
+    }
+    bool *reachable = malloc(sizeof(bool) * (fun_cnt + 1));
+    int   builtins;
+    if(reachable == NULL || !find_reachable(tree, fun_cnt, reachable, &builtins) || !generate_begin(builtins)){
+        free(reachable);
+        return false;
+    }
+
+    // Iterate through each AST function nodes
+    int i = 0;
+    for(astIdx fun = tree->first; fun != AST_NONE; fun = tree->nodes[fun].next, i++){
+        if(!reachable[i]) continue;
+        if(!generate_function(tree, fun, NULL)){
+            free(reachable);
+            return false;
+        }
+        // Code of finished functions is printed in big blocks, memory is reused for the next ones
+        if(BUFFER->size >= BUF_FLUSH_SIZE && !buf_flush(BUFFER, out)){
+            free(reachable);
+            return false;
+        }
+    }
+    free(reachable);
+
+    return generate_end(out);
+}
+
+/**
+ * @brief Sets where statistics of the code generated by this thread are collected.
+ *
+ * @param code_stats Zero-initialized statistics, or NULL to stop collecting them.
+ */
+void generate_stats(Code_stats *code_stats){
+    stats = code_stats;
+}
+
+/**
+ * @brief Prints parts of the code of one type.
+ */
+static void print_parts(Code_stats *code_stats, Code_part_type type, char *title, FILE *out){
+    fprintf(out, "%s:\n  %12s %12s  name\n", title, "instructions", "bytes");
+    for(int i = 0; i < code_stats->part_cnt; i++){
+        Code_part_stats *part = &code_stats->parts[i];
+        if(part->type == type){
+            fprintf(out, "  %12ld %12zu  %s\n", part->instructions, part->bytes, part->name);
+        }
+    }
+}
+
+/**
+ * @brief Prints report of the size of the generated code.
+ *
+ *        Report contains number of instructions per opcode, per function and per builtin helper,
+ *        size of the code in bytes and number of DEFVAR, PUSHS, POPS and CALL instructions.
+ *
+ * @param code_stats Statistics collected during generation.
+ * @param out Stream the report is printed to.
+ */
+void print_code_stats(Code_stats *code_stats, FILE *out){
+    long stack = 0;
+    int  order[OP_CNT];
+    for(int op = 0; op < OP_CNT; op++){
+        order[op] = op;
+        if(instr_uses_stack(op)) stack += code_stats->opcodes[op];
+    }
+
+    fprintf(out, "Generated code: %zu bytes, %ld instructions, %ld stack instructions\n",
+            code_stats->bytes, code_stats->instructions, stack);
+    fprintf(out, "DEFVAR %ld, PUSHS %ld, POPS %ld, CALL %ld\n", code_stats->opcodes[OP_DEFVAR],
+            code_stats->opcodes[OP_PUSHS], code_stats->opcodes[OP_POPS], code_stats->opcodes[OP_CALL]);
+
+    // opcodes are listed by decreasing number of instructions
+    for(int i = 1; i < OP_CNT; i++){
+        for(int j = i; j > 0 && code_stats->opcodes[order[j]] > code_stats->opcodes[order[j - 1]]; j--){
+            int tmp      = order[j];
+            order[j]     = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+    fprintf(out, "Instructions per opcode:\n");
+    for(int i = 0; i < OP_CNT && code_stats->opcodes[order[i]] > 0; i++){
+        long cnt = code_stats->opcodes[order[i]];
+        fprintf(out, "  %-12s %12ld %6.2f %%\n", opcode_names[order[i]], cnt, 100.0 * cnt / code_stats->instructions);
+    }
+
+    print_parts(code_stats, CODE_PART_FUNCTION, "Functions", out);
+    print_parts(code_stats, CODE_PART_BUILTIN, "Builtin helpers", out);
+    print_parts(code_stats, CODE_PART_PROGRAM, "Program header and footer", out);
+}
+
+/**
+ * @brief Frees memory of the statistics.
+ *
+ * @param code_stats Statistics to be freed.
+ */
+void free_code_stats(Code_stats *code_stats){
+    for(int i = 0; i < code_stats->part_cnt; i++){
+        free(code_stats->parts[i].name);
+    }
+    free(code_stats->parts);
+    code_stats->parts    = NULL;
+    code_stats->part_cnt = 0;
+    code_stats->part_cap = 0;
 }
 
 /* EOF code_generator.c */
\ No newline at end of file
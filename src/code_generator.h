@@ -17,6 +17,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include "code_buffer.h"
+#include "instruction.h"
 #include "ast.h"
 
 
@@ -24,21 +25,57 @@ typedef enum {INT, FLOAT, STRING} Types;
 
 typedef enum {WHILE_COND, WHILE_END, IF_ELSE, IF_END} LABEL_TYPES;
 
+// Builtin functions implemented by helper routines in the generated code, only called ones are generated
+#define BUILTIN_SUBSTRING 0x1
+#define BUILTIN_STRCMP    0x2
+#define BUILTIN_ORD       0x4
+#define BUILTIN_ALL       (BUILTIN_SUBSTRING | BUILTIN_STRCMP | BUILTIN_ORD)
+
 
 /**
  * @struct Defined_vars
- * @brief Structure to manage a list of defined variable names.
+ * @brief Structure to manage variables already defined in the frame of a function.
  *
- * This structure contains a dynamic array of strings (names) and a count of
- * the number of variables in the array.
+ * Variables are indexed by their frame slot assigned by the parser. Slots of
+ * compiler-defined variables follow after all slots of user variables.
  */
 typedef struct{
-    char ** names;
-    int num_of_vars;
+    bool   *defined;    // defined[slot] is true if DEFVAR for the slot was already generated
+    astIdx *names;      // names[slot] is the string offset of the name of a user variable
+    int     frame_size; // number of user variable slots in the frame
+    int     capacity;
+    Instr_stream *prologue; // instructions of the function prologue, DEFVARs of the body are appended to it
 } Defined_vars;
 
 
 
+typedef enum {CODE_PART_PROGRAM, CODE_PART_FUNCTION, CODE_PART_BUILTIN} Code_part_type;
+
+/**
+ * @struct Code_part_stats
+ * @brief Size of a part of the generated code: a function, a builtin helper, header or footer of the program.
+ */
+typedef struct{
+    char          *name;
+    Code_part_type type;
+    long           instructions;
+    size_t         bytes;
+} Code_part_stats;
+
+/**
+ * @struct Code_stats
+ * @brief Statistics of the generated code, collected when set by generate_stats().
+ */
+typedef struct{
+    long             opcodes[OP_CNT]; // number of instructions per opcode
+    long             instructions;    // number of all instructions
+    size_t           bytes;           // size of the printed code
+    Code_part_stats *parts;           // parts of the code in order of generation
+    int              part_cnt;
+    int              part_cap;
+} Code_stats;
+
+
 //#define DEBUG
 #ifdef DEBUG
     #ifndef DEBPRINT
@@ -201,26 +238,31 @@ typedef struct{
     "RETURN\n"
 
 
-bool add_int(int val);
-bool add_null();
-bool add_float(double val);
-bool add_string(char *str);
-bool add_read(char *var, Types type);
-bool add_write(char *term);
-bool add_i2f(char *var, char *symb);
-bool add_f2i(char *var, char *symb);
-bool add_str_len(char *var, char *symb);
-bool add_str_concat(char *var, char *symb1, char *symb2);
-bool add_chr(char *var, char *symb);
-bool generate_build_in_functions();
-bool generate_header();
-void inint_def_vars(Defined_vars *vars);
-bool def_var(Defined_vars *TF_vars, char *var_tmp, bool arg);
-bool is_in_def_vars(Defined_vars *vars, char *name);
+bool add_read(Operand var, Types type);
+bool add_write(Operand term);
+bool add_i2f(Operand var, Operand symb);
+bool add_f2i(Operand var, Operand symb);
+bool add_str_len(Operand var, Operand symb);
+bool add_str_concat(Operand var, Operand symb1, Operand symb2);
+bool add_chr(Operand var, Operand symb);
+int  builtin_helper(char *name);
+bool generate_build_in_functions(int builtins);
+bool generate_header(int builtins);
+bool inint_def_vars(Defined_vars *vars, int frame_size);
+bool def_var(Defined_vars *TF_vars, int slot, Operand var);
+bool is_in_def_vars(Defined_vars *vars, int slot);
 void delete_def_vars(Defined_vars *vars);
-void generate_label(char *label, LABEL_TYPES type, int number);
-bool code_generator(astNode *ast,  Defined_vars *TF_vars);
-bool generate_code(astNode *ast);
+Operand generate_label(LABEL_TYPES type, int number);
+bool code_generator(compactAST *tree, astIdx idx, Defined_vars *TF_vars);
+bool generate_begin(int builtins);
+bool generate_function(compactAST *tree, astIdx fun, char **code);
+bool generate_splice(char *name, char *code, int labels);
+int  generated_labels();
+bool generate_end(FILE *out);
+bool generate_code(compactAST *tree, FILE *out);
+void generate_stats(Code_stats *code_stats);
+void print_code_stats(Code_stats *code_stats, FILE *out);
+void free_code_stats(Code_stats *code_stats);
 
 
 #endif //CODE_GENERATOR_H
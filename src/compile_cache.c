@@ -0,0 +1,298 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   compile_cache.c
+ * 
+ * @brief  Implementation of on-disk cache of generated code.
+ * 
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "compile_cache.h"
+
+typedef struct cacheEntry{
+    time_t lastUse;
+    off_t  size;
+    char   name[CACHE_KEY_LEN + sizeof(CACHE_SUFFIX)];
+}cacheEntry;
+
+/**
+ * @brief       Adds bytes to two independent 64-bit hashes (FNV-1a and a multiplicative one).
+ * 
+ * @param h     Pointer to the pair of hashes.
+ * @param data  Bytes to add.
+ * @param len   Number of bytes.
+ */
+static void hashBytes(uint64_t h[2], const char *data, size_t len){
+    for(size_t i = 0; i < len; i++){
+        unsigned char c = data[i];
+        h[0] = (h[0] ^ c) * 0x100000001B3ULL;
+        h[1] = (h[1] ^ c) * 0x9E3779B97F4A7C15ULL;
+        h[1] ^= h[1] >> 29;
+    }
+}
+
+/**
+ * @brief       Copies the rest of one stream to another.
+ * 
+ * @return      true if everything was copied, false otherwise.
+ */
+static bool copyStream(FILE *from, FILE *to){
+    char   chunk[1 << 16];
+    size_t n;
+    while((n = fread(chunk, 1, sizeof(chunk), from)) > 0){
+        if(fwrite(chunk, 1, n, to) != n){
+            return false;
+        }
+    }
+    return !ferror(from);
+}
+
+/**
+ * @brief       Builds path of the entry for the current key.
+ */
+static bool entryPath(compileCache *cache, char *path){
+    int len = snprintf(path, CACHE_PATH_LEN, "%s/%s%s", cache->dir, cache->key, CACHE_SUFFIX);
+    return len > 0 && len < CACHE_PATH_LEN;
+}
+
+/**
+ * @brief       Compares entries by the time of last use, the oldest first.
+ */
+static int compareEntries(const void *a, const void *b){
+    const cacheEntry *x = a;
+    const cacheEntry *y = b;
+    return (x->lastUse > y->lastUse) - (x->lastUse < y->lastUse);
+}
+
+/**
+ * @brief       Prepares the cache, creates the directory if it does not exist.
+ * 
+ * @param cache   Pointer to the cache.
+ * @param dir     Directory of the cache.
+ * @param maxSize Bound of the total size of entries in bytes.
+ * 
+ * @return      true if the directory can be used, false otherwise.
+ */
+bool cacheInit(compileCache *cache, const char *dir, size_t maxSize){
+    cache->dir        = dir;
+    cache->maxSize    = maxSize;
+    cache->key[0]     = '\0';
+    cache->tmpPath[0] = '\0';
+
+    if(mkdir(dir, 0777) != 0 && errno != EEXIST){
+        return false;
+    }
+    struct stat st;
+    return stat(dir, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/**
+ * @brief       Computes the key of the entry for a source program.
+ * 
+ * @param cache   Pointer to the cache.
+ * @param source  Source program.
+ * @param len     Length of the source program.
+ */
+void cacheKey(compileCache *cache, const char *source, size_t len){
+    uint64_t h[2] = {0xCBF29CE484222325ULL, 0x84222325CBF29CE4ULL};
+    char     lenStr[32];
+    int      lenLen = snprintf(lenStr, sizeof(lenStr), "%zu", len);
+
+    // parts are separated by '\0', so they can not be shifted into each other
+    hashBytes(h, CACHE_VERSION, sizeof(CACHE_VERSION));
+    hashBytes(h, CACHE_BUILD_ID, sizeof(CACHE_BUILD_ID));
+    hashBytes(h, lenStr, lenLen + 1);
+    hashBytes(h, source, len);
+
+    snprintf(cache->key, sizeof(cache->key), "%016llx%016llx", (unsigned long long)h[0], (unsigned long long)h[1]);
+}
+
+/**
+ * @brief       Prints the cached code for the current key.
+ * 
+ *              Entry is read whole before anything is printed, so an entry which cannot be read
+ *              is a miss and the code can be generated to the same stream. Time of last use
+ *              of the entry is updated, so it is evicted later.
+ * 
+ * @param cache Pointer to the cache with computed key.
+ * @param out   Stream to print the code to.
+ * 
+ * @return      CACHE_HIT if the entry was printed, CACHE_MISS if it does not exist or cannot be read,
+ *              CACHE_FAILED if printing failed after a part of the code was printed.
+ */
+cacheResult cacheLookup(compileCache *cache, FILE *out){
+    char path[CACHE_PATH_LEN];
+    if(!entryPath(cache, path)){
+        return CACHE_MISS;
+    }
+
+    FILE *entry = fopen(path, "rb");
+    if(entry == NULL){
+        return CACHE_MISS;
+    }
+    utimensat(AT_FDCWD, path, NULL, 0); // entry may be evicted meanwhile, opened file stays readable
+
+    struct stat st;
+    char       *code = NULL;
+    size_t      size = 0;
+    if(fstat(fileno(entry), &st) == 0 && st.st_size >= 0){
+        size = (size_t)st.st_size;
+        code = malloc(size + 1);
+    }
+    bool read = code != NULL && fread(code, 1, size, entry) == size && fgetc(entry) == EOF && !ferror(entry);
+    fclose(entry);
+    if(!read){
+        free(code);
+        return CACHE_MISS;
+    }
+
+    bool printed = fwrite(code, 1, size, out) == size;
+    free(code);
+    return printed ? CACHE_HIT : CACHE_FAILED;
+}
+
+/**
+ * @brief       Creates a temporary file for a new entry.
+ * 
+ * @param cache Pointer to the cache with computed key.
+ * 
+ * @return      Opened file to write generated code to, NULL if it could not be created.
+ */
+FILE *cacheBegin(compileCache *cache){
+    int len = snprintf(cache->tmpPath, CACHE_PATH_LEN, "%s/%sXXXXXX", cache->dir, CACHE_TMP_PREFIX);
+    if(len <= 0 || len >= CACHE_PATH_LEN){
+        return NULL;
+    }
+
+    int fd = mkstemp(cache->tmpPath);
+    if(fd < 0){
+        return NULL;
+    }
+    fchmod(fd, 0644); // mkstemp creates the file readable only by its owner
+
+    FILE *entry = fdopen(fd, "w+b");
+    if(entry == NULL){
+        close(fd);
+        unlink(cache->tmpPath);
+    }
+    return entry;
+}
+
+/**
+ * @brief       Publishes the new entry and prints it.
+ * 
+ *              Temporary file is renamed to the entry, other compilers therefore never see
+ *              a partially written entry. Cache is trimmed to its bound afterwards.
+ * 
+ * @param cache Pointer to the cache.
+ * @param entry File returned by cacheBegin() with the generated code.
+ * @param out   Stream to print the code to.
+ * 
+ * @return      true if the code was printed, false otherwise.
+ */
+bool cacheCommit(compileCache *cache, FILE *entry, FILE *out){
+    char path[CACHE_PATH_LEN];
+
+    bool written = fflush(entry) == 0 && !ferror(entry);
+    if(!written || !entryPath(cache, path) || rename(cache->tmpPath, path) != 0){
+        unlink(cache->tmpPath);
+    }
+
+    rewind(entry);
+    bool ok = copyStream(entry, out);
+    fclose(entry);
+
+    cacheEvict(cache);
+    return ok;
+}
+
+/**
+ * @brief       Discards the new entry.
+ * 
+ * @param cache Pointer to the cache.
+ * @param entry File returned by cacheBegin().
+ */
+void cacheAbort(compileCache *cache, FILE *entry){
+    fclose(entry);
+    unlink(cache->tmpPath);
+}
+
+/**
+ * @brief       Removes least recently used entries until the cache fits its bound.
+ * 
+ *              Temporary files left by killed compilers are removed as well. Entries
+ *              removed by another compiler at the same time are skipped.
+ * 
+ * @param cache Pointer to the cache.
+ */
+void cacheEvict(compileCache *cache){
+    DIR *dir = opendir(cache->dir);
+    if(dir == NULL){
+        return;
+    }
+
+    cacheEntry *entries = NULL;
+    size_t      cnt = 0, cap = 0, total = 0;
+    time_t      now = time(NULL);
+    char        path[CACHE_PATH_LEN];
+
+    struct dirent *de;
+    while((de = readdir(dir)) != NULL){
+        size_t nameLen = strlen(de->d_name);
+        int    len = snprintf(path, CACHE_PATH_LEN, "%s/%s", cache->dir, de->d_name);
+        struct stat st;
+        if(len <= 0 || len >= CACHE_PATH_LEN || stat(path, &st) != 0 || !S_ISREG(st.st_mode)){
+            continue;
+        }
+
+        if(strncmp(de->d_name, CACHE_TMP_PREFIX, strlen(CACHE_TMP_PREFIX)) == 0){
+            if(now - st.st_mtime > CACHE_TMP_MAX_AGE){
+                unlink(path);
+            }
+            continue;
+        }
+        if(nameLen != CACHE_KEY_LEN + strlen(CACHE_SUFFIX) || strcmp(de->d_name + CACHE_KEY_LEN, CACHE_SUFFIX) != 0){
+            continue;
+        }
+
+        if(cnt == cap){
+            size_t      newCap = cap == 0 ? 64 : cap * 2;
+            cacheEntry *tmp = realloc(entries, newCap * sizeof(cacheEntry));
+            if(tmp == NULL){
+                break;
+            }
+            entries = tmp;
+            cap = newCap;
+        }
+        entries[cnt].lastUse = st.st_mtime;
+        entries[cnt].size    = st.st_size;
+        memcpy(entries[cnt].name, de->d_name, nameLen + 1);
+        total += st.st_size;
+        cnt++;
+    }
+    closedir(dir);
+
+    if(total > cache->maxSize){
+        qsort(entries, cnt, sizeof(cacheEntry), compareEntries);
+        for(size_t i = 0; i < cnt && total > cache->maxSize; i++){
+            snprintf(path, CACHE_PATH_LEN, "%s/%s", cache->dir, entries[i].name);
+            unlink(path);
+            total -= entries[i].size;
+        }
+    }
+    free(entries);
+}
+
+/* EOF compile_cache.c */
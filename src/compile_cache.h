@@ -0,0 +1,59 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   compile_cache.h
+ * 
+ * @brief  Header file for on-disk cache of generated code.
+ * 
+ *         Generated IFJcode24 is stored in a directory under a name derived from the hash
+ *         of the source program, CACHE_VERSION and CACHE_BUILD_ID. Entries are created by renaming
+ *         a finished temporary file, so several compilers can share the directory. Total size
+ *         of the entries is bounded, least recently used entries are evicted first.
+ * 
+ * @date   19.10.2026
+*/
+
+#ifndef COMPILE_CACHE_H
+#define COMPILE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define CACHE_VERSION      "ifj24 cache 1" // increase on every change of the generated code or of the format of entries
+// identifier of the build hashed into keys, so a rebuilt compiler does not use entries of the old one;
+// the Makefile sets it to a checksum of the sources, other builds use the time compile_cache.c was compiled
+#ifndef CACHE_BUILD_ID
+#define CACHE_BUILD_ID     __DATE__ " " __TIME__
+#endif
+#define CACHE_DEFAULT_SIZE (64UL * 1024 * 1024)
+#define CACHE_SUFFIX       ".ifjcode"
+#define CACHE_TMP_PREFIX   ".tmp-"
+#define CACHE_TMP_MAX_AGE  3600 // seconds, older temporary files are left over by killed compilers
+#define CACHE_KEY_LEN      32
+#define CACHE_PATH_LEN     4096
+
+typedef enum cacheResult{
+    CACHE_MISS,     // no entry, nothing was printed
+    CACHE_HIT,      // entry was printed
+    CACHE_FAILED    // printing of the entry failed, output is incomplete
+}cacheResult;
+
+typedef struct compileCache{
+    const char *dir;
+    size_t      maxSize;                    // bound of total size of entries in bytes
+    char        key[CACHE_KEY_LEN + 1];     // hex digest of the source, version and build
+    char        tmpPath[CACHE_PATH_LEN];    // temporary file of the entry being created
+}compileCache;
+
+bool  cacheInit   (compileCache *cache, const char *dir, size_t maxSize);
+void  cacheKey    (compileCache *cache, const char *source, size_t len);
+cacheResult cacheLookup(compileCache *cache, FILE *out);
+FILE *cacheBegin  (compileCache *cache);
+bool  cacheCommit (compileCache *cache, FILE *entry, FILE *out);
+void  cacheAbort  (compileCache *cache, FILE *entry);
+void  cacheEvict  (compileCache *cache);
+
+#endif //COMPILE_CACHE_H
+
+/* EOF compile_cache.h */
@@ -0,0 +1,234 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   compile_server.c
+ * 
+ * @brief  Implementation of compile server listening on a UNIX socket and its client.
+ * 
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "compile_server.h"
+#include "file_io.h"
+#include "code_generator.h"
+#include "parser.h"
+
+/**
+ * @brief       Reads exactly len bytes from a descriptor.
+ * 
+ * @return      true if all bytes were read, false on error or end of file.
+ */
+static bool readFull(int fd, void *data, size_t len){
+    char *ptr = data;
+    while(len > 0){
+        ssize_t n = read(fd, ptr, len);
+        if(n <= 0){
+            return false;
+        }
+        ptr += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief       Writes exactly len bytes to a descriptor.
+ * 
+ * @return      true if all bytes were written, false otherwise.
+ */
+static bool writeFull(int fd, const void *data, size_t len){
+    const char *ptr = data;
+    while(len > 0){
+        ssize_t n = write(fd, ptr, len);
+        if(n <= 0){
+            return false;
+        }
+        ptr += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief       Fills address of a UNIX socket.
+ * 
+ * @return      true if the path fits into the address, false otherwise.
+ */
+static bool socketAddress(const char *path, struct sockaddr_un *addr){
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr->sun_path)){
+        return false;
+    }
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+/**
+ * @brief       Serves one connection of a client.
+ * 
+ * @param fd    Descriptor of the connection.
+ */
+static void serveRequest(int fd){
+    uint32_t len;
+    if(!readFull(fd, &len, sizeof(len))){
+        return;
+    }
+    len = ntohl(len);
+    if(len > SERVER_MAX_PROGRAM){
+        return;
+    }
+
+    char *source = malloc(len + 1); // fmemopen does not accept empty buffers everywhere
+    if(source == NULL || !readFull(fd, source, len)){
+        free(source);
+        return;
+    }
+
+    char  *code = NULL, *diag = NULL;
+    size_t codeLen = 0, diagLen = 0;
+    FILE  *input = fmemopen(source, len + 1, "r");
+    FILE  *out   = open_memstream(&code, &codeLen);
+    FILE  *err   = open_memstream(&diag, &diagLen);
+
+    int ret = ERR_INTERNAL;
+    if(input != NULL && out != NULL && err != NULL){
+        source[len] = ' '; // extra byte is white space, so it does not change the program
+        ret = ifj24CompileStream(input, out, err);
+    }
+    if(input != NULL) fclose(input);
+    if(out != NULL) fclose(out);
+    if(err != NULL) fclose(err);
+
+    if(ret != 0){ // code of a failed program is not sent
+        codeLen = 0;
+    }
+
+    uint32_t header[3] = {htonl(ret), htonl(codeLen), htonl(diagLen)};
+    if(writeFull(fd, header, sizeof(header)) && writeFull(fd, code, codeLen)){
+        writeFull(fd, diag, diagLen);
+    }
+
+    free(code);
+    free(diag);
+    free(source);
+}
+
+/**
+ * @brief       Serves a connection on its own thread and closes it.
+ * 
+ * @param arg   Descriptor of the connection, cast to a pointer.
+ */
+static void *serveConnection(void *arg){
+    int fd = (int)(intptr_t)arg;
+    serveRequest(fd);
+    close(fd);
+    return NULL;
+}
+
+/**
+ * @brief       Listens on a UNIX socket and compiles programs sent by clients, until killed.
+ * 
+ * @param path  Path of the socket, existing file is replaced.
+ * 
+ * @return      Exit code of the compiler, if the socket can not be used.
+ */
+int runServer(const char *path){
+    struct sockaddr_un addr;
+    if(!socketAddress(path, &addr)){
+        fprintf(stderr, "\nERROR NUMBER %d: Socket path %s is too long\n", ERR_INTERNAL, path);
+        return ERR_INTERNAL;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if(sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(sock, SERVER_BACKLOG) != 0){
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot listen on %s\n", ERR_INTERNAL, path);
+        if(sock >= 0) close(sock);
+        return ERR_INTERNAL;
+    }
+    signal(SIGPIPE, SIG_IGN); // client closing its connection early must not end the server
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    // a client which stops sending or reading is dropped, so it does not hold its thread forever
+    struct timeval timeout = {.tv_sec = SERVER_TIMEOUT_S, .tv_usec = 0};
+    while(true){
+        int fd = accept(sock, NULL, NULL);
+        if(fd < 0){
+            continue;
+        }
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // every connection has its own thread, so a slow client does not stall the others
+        pthread_t thread;
+        if(pthread_create(&thread, &attr, serveConnection, (void *)(intptr_t)fd) != 0){
+            serveConnection((void *)(intptr_t)fd);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief       Sends standard input to the server and prints its answer like the compiler would.
+ * 
+ * @param path  Path of the socket of the server.
+ * 
+ * @return      Exit code of the compilation, ERR_INTERNAL if the server can not be used.
+ */
+int runClient(const char *path){
+    struct sockaddr_un addr;
+    size_t len;
+    char  *source = readAll(stdin, &len);
+    int    sock   = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(source == NULL || len > SERVER_MAX_PROGRAM || sock < 0 || !socketAddress(path, &addr)
+       || connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0){
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot reach compile server at %s\n", ERR_INTERNAL, path);
+        free(source);
+        if(sock >= 0) close(sock);
+        return ERR_INTERNAL;
+    }
+
+    uint32_t header[3] = {htonl(len)};
+    char    *answer    = NULL;
+    bool     ok        = writeFull(sock, header, sizeof(uint32_t)) && writeFull(sock, source, len)
+                      && readFull(sock, header, sizeof(header));
+    if(ok){
+        size_t codeLen = ntohl(header[1]);
+        size_t diagLen = ntohl(header[2]);
+        answer = malloc(codeLen + diagLen + 1);
+        ok = answer != NULL && readFull(sock, answer, codeLen + diagLen);
+        if(ok){
+            fwrite(answer, 1, codeLen, stdout);
+            fwrite(answer + codeLen, 1, diagLen, stderr);
+        }
+    }
+    close(sock);
+    free(source);
+    free(answer);
+
+    if(!ok){
+        fprintf(stderr, "\nERROR NUMBER %d: Compile server at %s did not answer\n", ERR_INTERNAL, path);
+        return ERR_INTERNAL;
+    }
+    return ntohl(header[0]);
+}
+
+/* EOF compile_server.c */
@@ -0,0 +1,36 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   compile_server.h
+ * 
+ * @brief  Header file for compile server listening on a UNIX socket and its client.
+ * 
+ *         Server compiles programs in one process, each connection on its own thread, so the cost
+ *         of starting the compiler is paid once. Errors of a program do not end the server, see
+ *         errorRecovery. A connection is dropped when the client does not send or read any data
+ *         for SERVER_TIMEOUT_S seconds.
+ * 
+ *         Every connection carries one request:
+ *           client -> server   uint32 length of the program, program
+ *           server -> client   uint32 exit code, uint32 length of the code, uint32 length of
+ *                              the diagnostics, code, diagnostics
+ *         Numbers are in network byte order.
+ * 
+ * @date   19.10.2026
+*/
+
+#ifndef COMPILE_SERVER_H
+#define COMPILE_SERVER_H
+
+#include "ifj24.h"
+
+#define SERVER_MAX_PROGRAM (64UL * 1024 * 1024) // longer programs are refused
+#define SERVER_BACKLOG     64
+#define SERVER_TIMEOUT_S   10 // seconds a connection may stay without any progress
+
+int   runServer     (const char *path);
+int   runClient     (const char *path);
+
+#endif //COMPILE_SERVER_H
+
+/* EOF compile_server.h */
@@ -13,16 +13,27 @@
 #include "symtable.h"
 #include "scanner.h"
 #include "parser.h"
+#include "arena.h"
+
+THREAD_LOCAL jmp_buf *errorRecovery = NULL;
+THREAD_LOCAL int      errorNumber   = 0;
+THREAD_LOCAL FILE    *errorOutput   = NULL;
 
 /** 
  * @brief Controls all allocations in program and deletes everything.
+ * 
+ *        AST, symtables and function data are released in bulk with their
+ *        arena and pools, nothing is traversed.
 */
 void delete_all_allocated(){
 
-    freeASTNode(ASTree.root);
-    deleteSymtable(builtinSymtable);
-    deleteSymtable(funSymtable);
-    free_all_values();
+    freeStack(&symtableStack); // scopes left open by an error
+    exp_release_all();         // expressions interrupted by an error
+    frameSlots  = NULL;
+    ASTree.root = NULL;
+    funSymtable = NULL;
+    arenaRelease(&compileArena); // token values are in the arena as well
+    releaseSymPools();
     
 }
 
@@ -14,6 +14,8 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include <setjmp.h>
+#include "thread_local.h"
 #include "symtable.h"
 #include "scanner.h"
 
@@ -34,17 +36,32 @@
  * "Wrong ID in prologue section.\nExpected: \"ifj\"\nGot: %s\n", currentToken.value
  */
 
+/* when set, errors jump here instead of ending the compiler, so a long-running compiler
+   can continue with the next program; the error number is stored in errorNumber, as
+   setjmp() may only be compared, not assigned: if(setjmp(recovery) != 0){ ... errorNumber ... } */
+extern THREAD_LOCAL jmp_buf *errorRecovery;
+extern THREAD_LOCAL int      errorNumber;
+
+/* stream error messages are printed to, standard error output is used when NULL */
+extern THREAD_LOCAL FILE *errorOutput;
+
+#define ERROR_OUTPUT (errorOutput != NULL ? errorOutput : stderr)
+
 #define ERROR(errNum, ...) do { \
-    fprintf(stderr, "\nERROR NUMBER %d at line %d column %d: ", errNum, currentToken.line, currentToken.column); \
-    fprintf(stderr, __VA_ARGS__); \
+    fprintf(ERROR_OUTPUT, "\nERROR NUMBER %d at line %d column %d: ", errNum, currentToken.line, currentToken.column); \
+    fprintf(ERROR_OUTPUT, __VA_ARGS__); \
     delete_all_allocated(); \
+    errorNumber = errNum; \
+    if(errorRecovery != NULL) longjmp(*errorRecovery, errNum); \
     exit(errNum); \
 } while (0)
 
 #define ERRORLEX(errNum, ...) do{\
-    fprintf(stderr, "\nERROR NUMBER %d: ", errNum); \
-    fprintf(stderr, __VA_ARGS__); \
-    free_all_values(); \
+    fprintf(ERROR_OUTPUT, "\nERROR NUMBER %d: ", errNum); \
+    fprintf(ERROR_OUTPUT, __VA_ARGS__); \
+    delete_all_allocated(); \
+    errorNumber = errNum; \
+    if(errorRecovery != NULL) longjmp(*errorRecovery, errNum); \
     exit(errNum); \
 } while (0)
 
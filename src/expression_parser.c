@@ -29,6 +29,9 @@
 #include <stdio.h>
 #include "expression_parser.h"
 
+THREAD_LOCAL arena exprArena = {.head = NULL}; // temporary data of expressions being parsed
+static THREAD_LOCAL int exprDepth = 0;       // number of expressions being parsed (nested through function calls)
+
 
 /**************************************************************************************************************************************************/
 /*                                                        Precedence table                                                                        */
@@ -71,10 +74,8 @@ precedence precedence_table[14][14] = {
 * @return Empty expression stack.
 */
 exp_stack *exp_stack_create(){
-    exp_stack *Stack = (exp_stack *)malloc(sizeof(exp_stack));
-    if(Stack == NULL){
-        ERROR(ERR_INTERNAL, "Failed to allocate memory for stack.");
-    }
+    exp_stack *Stack = arenaAlloc(&exprArena, sizeof(exp_stack));
+    exprDepth++;
     Stack->top = NULL;
     Stack->count = 0;
     return Stack;
@@ -90,10 +91,7 @@ exp_stack *exp_stack_create(){
 * @param control Pointer to struct with additional control values. 
 */
 void exp_stack_push(exp_stack *estack, astNode *node, symbol_number op, control_items *control){
-    stack_item *new_item = (stack_item *)malloc(sizeof(stack_item));
-    if(new_item == NULL){
-        ERROR(ERR_INTERNAL, "Failed to allocated memory for stack element"); 
-    }
+    stack_item *new_item = arenaAlloc(&exprArena, sizeof(stack_item));
     new_item->control = control;
     new_item->node = node;
     new_item->expr = op;
@@ -110,7 +108,7 @@ void exp_stack_push(exp_stack *estack, astNode *node, symbol_number op, control_
  * @brief Pop top AST node from expression stack.
  * 
  * @param estack Pointer to stack.
- * @param control_needed False if we can free allocated control struct. True if we need control struct.
+ * @param control_needed Kept for callers, control structs are released with exprArena.
  * 
  * @return Node of top stack item.
  */
@@ -118,13 +116,9 @@ astNode *exp_stack_pop(exp_stack *estack, bool control_needed){
     if (estack->top == NULL){
         return NULL;
     }
+    (void)control_needed;
     astNode *top_node = estack->top->node;
-    stack_item *top_to_delete = estack->top;
     estack->top = estack->top->next;
-    if(!control_needed){
-        free(top_to_delete->control);
-    }
-    free(top_to_delete);
     estack->count--;
     return top_node;
 }
@@ -152,18 +146,25 @@ symbol_number exp_stack_top_term_symb(exp_stack *estack){
 /**
  * @brief Frees all memory allocated for the stack and its contents.
  * 
+ *        Stacks, their items and control structs are allocated in exprArena, which is reset
+ *        when the outermost expression is finished (expressions nest through function calls).
+ *        AST nodes in the stack are allocated in compileArena and are released with it.
+ * 
  * @param estack Pointer to expression stack.
  */
 void exp_stack_free_stack(exp_stack *estack){
-    stack_item *curr = estack->top;
-    while(curr){
-        stack_item *next_item = curr->next;
-        freeASTNode(curr->node);
-        free(curr->control);
-        free(curr);
-        curr = next_item;
+    (void)estack;
+    if(--exprDepth == 0){
+        arenaReset(&exprArena);
     }
-    free(estack);
+}
+
+/**
+ * @brief Releases memory of all expressions in progress, used when an error interrupts parsing.
+ */
+void exp_release_all(){
+    arenaRelease(&exprArena);
+    exprDepth = 0;
 }
 
 
@@ -209,10 +210,10 @@ bool expression(astNode *expr_node){
         
         control_items *expr_items = estack->top->control;
         astNode *final_exp = exp_stack_pop(estack, true);
+        retype(final_exp, unknown);                 // apply implicit conversions recorded by semantic_check
         
         createExpressionNode(expr_node, expr_items->type, final_exp, expr_items->is_nullable, expr_items->known_during_compile); 
         
-        free(expr_items);
         exp_stack_free_stack(estack);
         
         return true;
@@ -233,10 +234,7 @@ bool process_expr(exp_stack *estack){
     astNode *curr_node = createAstNode();
     
 
-    control_items *control =(control_items *)malloc(sizeof(struct control_items));
-    if(control == NULL){
-        ERROR(ERR_INTERNAL, "Failed to allocate memory for control struct"); 
-    }
+    control_items *control = arenaAlloc(&exprArena, sizeof(struct control_items));
 
     // initialization of empty controls
     control->is_convertable = false;
@@ -284,8 +282,6 @@ int shift(exp_stack *estack, astNode *curr_node, control_items *control, symbol_
     
     if(curr_symb == RBR && exp_stack_find_lbr(estack) == false){
         curr_symb = STOP;
-        free(curr_node);
-        free(control);
     }
 
     symbol_number top_term = exp_stack_top_term_symb(estack);
@@ -340,15 +336,13 @@ void reduce(exp_stack *estack){
             return;
  
         case RBR :{
-            astNode *rbr = exp_stack_pop(estack, false);                // delete right bracket item from stack
-            freeASTNode(rbr); 
+            exp_stack_pop(estack, false);                               // delete right bracket item from stack
             control_items *operand_items = estack->top->control;
             astNode *expr = exp_stack_pop(estack, true);
             if(estack->top->expr != LBR){
                 ERROR(ERR_SYNTAX, "Unexpected \")\" in expression ");
             }
-            astNode *lbr = exp_stack_pop(estack, false);                // delete left bracket item from stack
-            freeASTNode(lbr);
+            exp_stack_pop(estack, false);                               // delete left bracket item from stack
             exp_stack_push(estack, expr, NO_TERMINAL, operand_items);
             return;
         }
@@ -381,7 +375,7 @@ void reduce(exp_stack *estack){
         ERROR(ERR_SYNTAX, "Invalid character in expression\n");
     }
     
-    control_items *operation_item = (control_items *)malloc(sizeof(struct control_items));
+    control_items *operation_item = arenaAlloc(&exprArena, sizeof(struct control_items));
     
     semantic_check(estack->top->next->next, estack->top->next, estack->top, operation_item);
     
@@ -459,8 +453,6 @@ symbol_number evaluate_given_token(exp_stack *estack, Token token, astNode *node
                 
                 return RBR;
             }
-            freeASTNode(node);
-            free(control);
             return STOP;
 
         case tokentype_id :
@@ -580,8 +572,6 @@ symbol_number evaluate_given_token(exp_stack *estack, Token token, astNode *node
             return ID;
 
         default:
-            freeASTNode(node);
-            free(control);
             return STOP;
         
 
@@ -650,7 +640,7 @@ void semantic_check(stack_item *left_operand, stack_item *operator, stack_item *
     }
 
     else if(right_operand->control->is_convertable == true && right_operand->control->type == i32){
-        retype(right_operand->node);
+        markRetype(right_operand->node, left_operand->control->type);
         control->type = left_operand->control->type;
         if(left_operand->control->is_convertable == true){
             control->is_convertable = true;
@@ -662,7 +652,7 @@ void semantic_check(stack_item *left_operand, stack_item *operator, stack_item *
     }
 
     else if(left_operand->control->is_convertable == true && left_operand->control->type == i32){
-        retype(left_operand->node);
+        markRetype(left_operand->node, right_operand->control->type);
         control->type = right_operand->control->type;
         if(right_operand->control->is_convertable == true){
             control->is_convertable = true;
@@ -675,7 +665,7 @@ void semantic_check(stack_item *left_operand, stack_item *operator, stack_item *
 
 
     else if(right_operand->control->is_convertable == true){
-        retype(right_operand->node);
+        markRetype(right_operand->node, left_operand->control->type);
         control->type = left_operand->control->type;
         if(left_operand->control->is_convertable == true){
             control->is_convertable = true;
@@ -688,7 +678,7 @@ void semantic_check(stack_item *left_operand, stack_item *operator, stack_item *
     }
 
     else if(left_operand->control->is_convertable == true){
-        retype(left_operand->node);
+        markRetype(left_operand->node, right_operand->control->type);
 
         control->type = right_operand->control->type;
 
@@ -708,21 +698,63 @@ void semantic_check(stack_item *left_operand, stack_item *operator, stack_item *
 }
 
 /**
- * @brief Function that retypes nodes in an expression tree.  
+ * @brief Records that an operand (subtree) has to be implicitly converted to a different type.
  * 
- * @param operand   Pointer to a node (subtree) in the expression tree that needs to be retyped.  
+ *        Only the root of the operand is marked, the conversion itself is performed
+ *        once for the whole expression by retype().
+ * 
+ * @param operand   Pointer to a node (subtree) in the expression tree that needs to be retyped.
+ * @param target    Data type the operand is converted to.
  */
-void retype(astNode *operand){
-    
+void markRetype(astNode *operand, dataType target){
     if(operand->type == AST_NODE_BINOP){
-        
-        retype(operand->nodeRep.binOpNode.left);
-        retype(operand->nodeRep.binOpNode.right);
+        operand->nodeRep.binOpNode.retypeTo = target;
+    }
+    else if(operand->type == AST_NODE_LITERAL){
+        operand->nodeRep.literalNode.retypeTo = target;
+    }
+}
+
+/**
+ * @brief Function that applies recorded conversions to nodes in an expression tree.  
+ * 
+ *        Tree is traversed only once, top-down. Conversion recorded on an outer node
+ *        takes precedence over conversions recorded inside of its subtree, as convertable
+ *        subtrees always hold operands of a single type. Only literal leaves are converted,
+ *        data types of binary operators are kept. Operands of a division are not converted,
+ *        the conversion stays recorded on the division and is applied to its result.
+ * 
+ * @param operand   Pointer to a node (subtree) in the expression tree to retype.
+ * @param target    Data type forced by an ancestor node, unknown if there is none.
+ */
+void retype(astNode *operand, dataType target){
+    if(operand == NULL){
+        return;
+    }
+    if(operand->type == AST_NODE_BINOP){
+        if(target == unknown){
+            target = operand->nodeRep.binOpNode.retypeTo;
+        }
+        if(operand->nodeRep.binOpNode.op == DIVISION && target != unknown && target != operand->nodeRep.binOpNode.dataT){
+            // division is computed in its own type (1 / 2 is 0), only its result is converted
+            operand->nodeRep.binOpNode.retypeTo = target;
+            retype(operand->nodeRep.binOpNode.left, unknown);
+            retype(operand->nodeRep.binOpNode.right, unknown);
+            return;
+        }
+        operand->nodeRep.binOpNode.retypeTo = unknown;
+        retype(operand->nodeRep.binOpNode.left, target);
+        retype(operand->nodeRep.binOpNode.right, target);
         return;
     }
     else if(operand->type == AST_NODE_LITERAL){
-        
+        if(target == unknown){
+            target = operand->nodeRep.literalNode.retypeTo;
+        }
         dataType type = operand->nodeRep.literalNode.dataT;
+        if(target == unknown || target == type){
+            return;
+        }
         
         if(type == i32){
             int value = operand->nodeRep.literalNode.value.intData;
@@ -67,6 +67,7 @@ void exp_stack_push(exp_stack *estack, astNode *node, symbol_number op, control_
 astNode *exp_stack_pop(exp_stack *estack, bool control_needed);
 symbol_number exp_stack_top_term_symb(exp_stack *estack); 
 void exp_stack_free_stack(exp_stack *estack);
+void exp_release_all();
 bool exp_stack_find_lbr(exp_stack *estack);
 
 /******* Functions for expression parser *******/
@@ -76,7 +77,8 @@ symbol_number evaluate_given_token(exp_stack *estack, Token token, astNode *node
 int shift(exp_stack *estack, astNode *curr_node, control_items *control, symbol_number curr_symb);
 void reduce(exp_stack *estack);
 void semantic_check(stack_item *left_operand, stack_item *operator, stack_item *right_operand, control_items *control);
-void retype(astNode *operand);
+void markRetype(astNode *operand, dataType target);
+void retype(astNode *operand, dataType target);
 
 
 #endif // EXPRESSION_PARSER_H
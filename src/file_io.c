@@ -0,0 +1,48 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   file_io.c
+ * 
+ * @brief  Implementation of helpers reading whole streams.
+ * 
+ * @date   19.10.2026
+*/
+
+#include <stdlib.h>
+#include "file_io.h"
+
+/**
+ * @brief       Reads the whole stream into memory.
+ * 
+ * @param input Stream to read.
+ * @param len   Pointer where length of the read data is stored.
+ * 
+ * @return      Allocated buffer with the data, NULL if it could not be read.
+ */
+char *readAll(FILE *input, size_t *len){
+    size_t cap  = 1 << 16;
+    size_t used = 0;
+    char  *data = malloc(cap);
+
+    while(data != NULL){
+        used += fread(data + used, 1, cap - used, input);
+        if(used < cap){
+            break;
+        }
+        char *tmp = realloc(data, cap * 2);
+        if(tmp == NULL){
+            free(data);
+            return NULL;
+        }
+        data = tmp;
+        cap *= 2;
+    }
+    if(data != NULL && ferror(input)){
+        free(data);
+        return NULL;
+    }
+    *len = used;
+    return data;
+}
+
+/* EOF file_io.c */
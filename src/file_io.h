@@ -0,0 +1,21 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   file_io.h
+ * 
+ * @brief  Header file for helpers reading whole streams, shared by the modes of the compiler.
+ * 
+ * @date   19.10.2026
+*/
+
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+char *readAll       (FILE *input, size_t *len);
+
+#endif //FILE_IO_H
+
+/* EOF file_io.h */
@@ -0,0 +1,143 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   ifj24.c
+ *
+ * @brief  Implementation of interface of the compiler as a library.
+ *
+ * @date   19.10.2026
+*/
+
+#define _POSIX_C_SOURCE 200809L // fmemopen, open_memstream
+
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "ifj24.h"
+#include "code_generator.h"
+#include "parser.h"
+
+/* compact AST of the program being compiled, not a local variable, so it can be freed
+   after an error (locals changed after setjmp() are indeterminate after longjmp()) */
+static THREAD_LOCAL compactAST libTree;
+
+/**
+ * @brief       Compiles one program without ending the process on errors.
+ *
+ *              Errors are recovered until everything is released, including allocation
+ *              failures while lowering the AST and generating code.
+ *
+ * @param input       Stream with the program, it has to support rewind.
+ * @param out         Stream the generated code is printed to.
+ * @param diagnostics Stream error messages are printed to.
+ *
+ * @return      Exit code of the compilation.
+ */
+int ifj24CompileStream(FILE *input, FILE *out, FILE *diagnostics){
+    jmp_buf recovery;
+    if(setjmp(recovery) != 0){ // everything else was released by the error already
+        errorRecovery = NULL;
+        errorOutput   = NULL;
+        freeCompactAST(&libTree);
+        set_input(NULL);
+        return errorNumber;
+    }
+
+    errorRecovery = &recovery;
+    errorOutput   = diagnostics;
+    set_input(input);
+    reset_scanner();
+
+    ASTree.root = parser();
+
+    buildCompactAST(&libTree, ASTree.root);
+    bool ok = generate_code(&libTree, out);
+    freeCompactAST(&libTree);
+
+    delete_all_allocated();
+    errorRecovery = NULL;
+    errorOutput   = NULL;
+    set_input(NULL);
+    return ok ? 0 : ERR_INTERNAL;
+}
+
+/**
+ * @brief       Stores the error message without its surrounding new lines.
+ */
+static void setMessage(ifj24Error *err, const char *text, size_t len){
+    while(len > 0 && *text == '\n'){
+        text++;
+        len--;
+    }
+    while(len > 0 && text[len - 1] == '\n'){
+        len--;
+    }
+    if(len >= IFJ24_MESSAGE_LEN){
+        len = IFJ24_MESSAGE_LEN - 1;
+    }
+    memcpy(err->message, text, len);
+    err->message[len] = '\0';
+}
+
+/**
+ * @brief       Compiles a program from memory into memory.
+ *
+ * @param source Text of the program.
+ * @param len    Length of the program.
+ * @param out    Buffer the generated code is stored to, it is not terminated by '\0'.
+ * @param outCap Size of the buffer.
+ * @param outLen Pointer where length of the generated code is stored, also when it does not fit. Can be NULL.
+ * @param err    Pointer where the error is described. Can be NULL.
+ *
+ * @return      IFJ24_OK, IFJ24_ERR_SPACE or exit code of the compiler.
+ */
+int ifj24Compile(const char *source, size_t len, char *out, size_t outCap, size_t *outLen, ifj24Error *err){
+    ifj24Error unused;
+    if(err == NULL){
+        err = &unused;
+    }
+    memset(err, 0, sizeof(ifj24Error));
+
+    char  *code = NULL, *diag = NULL;
+    size_t codeLen = 0, diagLen = 0;
+
+    // stream is only read, empty program is replaced by white space, because fmemopen does not accept empty buffers everywhere
+    FILE *input      = len > 0 ? fmemopen((void *)source, len, "r") : fmemopen(" ", 1, "r");
+    FILE *codeStream = open_memstream(&code, &codeLen);
+    FILE *diagStream = open_memstream(&diag, &diagLen);
+
+    int ret = ERR_INTERNAL;
+    if(input != NULL && codeStream != NULL && diagStream != NULL){
+        currentToken.line = currentToken.column = 0;
+        ret = ifj24CompileStream(input, codeStream, diagStream);
+    }
+    if(input != NULL) fclose(input);
+    if(codeStream != NULL) fclose(codeStream);
+    if(diagStream != NULL) fclose(diagStream);
+
+    if(ret == IFJ24_OK && codeLen > outCap){
+        ret = IFJ24_ERR_SPACE;
+        snprintf(err->message, IFJ24_MESSAGE_LEN, "Generated code needs %zu bytes, buffer has %zu.", codeLen, outCap);
+    }
+    else if(ret == IFJ24_OK){
+        memcpy(out, code, codeLen);
+    }
+    else{
+        err->line   = ret == ERR_LEX ? Line_Number   : currentToken.line;
+        err->column = ret == ERR_LEX ? Column_Number : currentToken.column;
+        if(diag != NULL){
+            setMessage(err, diag, diagLen);
+        }
+    }
+
+    if(outLen != NULL){
+        *outLen = ret == IFJ24_OK || ret == IFJ24_ERR_SPACE ? codeLen : 0;
+    }
+    err->code = ret;
+
+    free(code);
+    free(diag);
+    return ret;
+}
+
+/* EOF ifj24.c */
@@ -0,0 +1,41 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   ifj24.h
+ *
+ * @brief  Interface of the compiler as a library (libifj24), for programs embedding it.
+ *
+ *         Errors in the program do not end the calling process, they are returned
+ *         as exit codes the compiler would end with (see error.h) together with the message.
+ *         State of a compilation is thread local, so threads can compile different
+ *         programs at the same time, one program at a time in each thread.
+ *
+ * @date   19.10.2026
+*/
+
+#ifndef IFJ24_H
+#define IFJ24_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define IFJ24_OK          0   // program was compiled
+#define IFJ24_ERR_SPACE   100 // generated code does not fit into the given buffer
+
+#define IFJ24_MESSAGE_LEN 256
+
+typedef struct ifj24Error {
+
+    int  code;                       // IFJ24_OK, IFJ24_ERR_SPACE or exit code of the compiler
+    int  line;                       // position of the error in the program, 0 if unknown
+    int  column;
+    char message[IFJ24_MESSAGE_LEN]; // error message, truncated if longer
+
+}ifj24Error;
+
+int ifj24Compile      (const char *source, size_t len, char *out, size_t outCap, size_t *outLen, ifj24Error *err);
+int ifj24CompileStream(FILE *input, FILE *out, FILE *diagnostics);
+
+#endif //IFJ24_H
+
+/* EOF ifj24.h */
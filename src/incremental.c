@@ -0,0 +1,450 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   incremental.c
+ *
+ * @brief  Implementation of incremental recompilation of a program which is compiled repeatedly.
+ *
+ * @date   19.10.2026
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "incremental.h"
+#include "code_generator.h"
+#include "parser.h"
+
+#define HASH_BASIS 0xCBF29CE484222325ULL
+#define HASH_PRIME 0x100000001B3ULL
+
+THREAD_LOCAL incrState *incremental = NULL;
+
+/**
+ * @brief       Adds bytes to FNV-1a hash.
+ */
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t len){
+    const unsigned char *bytes = data;
+    for(size_t i = 0; i < len; i++){
+        hash = (hash ^ bytes[i]) * HASH_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief       Frees everything owned by the records of functions.
+ */
+static void freeFunctions(incrFunction *funs, int cnt){
+    for(int i = 0; i < cnt; i++){
+        free(funs[i].name);
+        for(int j = 0; j < funs[i].callCnt; j++){
+            free(funs[i].calls[j]);
+        }
+        free(funs[i].calls);
+        freeCompactAST(&funs[i].tree);
+        free(funs[i].code);
+    }
+    free(funs);
+}
+
+/**
+ * @brief       Finds a function by name in an array of records.
+ *
+ * @return      Index of the function, -1 if not found.
+ */
+static int findFunction(incrFunction *funs, int cnt, char *name){
+    for(int i = 0; i < cnt; i++){
+        if(strcmp(funs[i].name, name) == 0){
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief       Collects distinct user functions and builtin helper routines called in the compact AST of a function.
+ *
+ * @return      true if successful, false if memory allocation fails.
+ */
+static bool collectCalls(incrFunction *fun){
+    compactAST *tree = &fun->tree;
+    int         cap  = 0;
+
+    for(astIdx i = 0; i < tree->nodeCnt; i++){
+        compactNode *node = &tree->nodes[i];
+        if(node->type != AST_NODE_FUNC_CALL){
+            continue;
+        }
+        if(node->flags & COMPACT_BUILTIN){
+            fun->builtins |= builtin_helper(compactString(tree, node->a));
+            continue;
+        }
+
+        char *name  = compactString(tree, node->a);
+        bool  known = false;
+        for(int j = 0; j < fun->callCnt && !known; j++){
+            known = strcmp(fun->calls[j], name) == 0;
+        }
+        if(known){
+            continue;
+        }
+
+        if(fun->callCnt == cap){
+            cap = cap == 0 ? 8 : cap * 2;
+            char **tmp = realloc(fun->calls, sizeof(char *) * cap);
+            if(tmp == NULL){
+                return false;
+            }
+            fun->calls = tmp;
+        }
+        fun->calls[fun->callCnt] = malloc(strlen(name) + 1);
+        if(fun->calls[fun->callCnt] == NULL){
+            return false;
+        }
+        strcpy(fun->calls[fun->callCnt++], name);
+    }
+    return true;
+}
+
+/**
+ * @brief       Initializes the state with no previous compilation.
+ *
+ * @param st    Pointer to the state.
+ */
+void incrInit(incrState *st){
+    st->prev        = NULL;
+    st->prevCnt     = 0;
+    st->cur         = NULL;
+    st->curCnt      = 0;
+    st->curCap      = 0;
+    st->secPos      = 0;
+    st->hash        = HASH_BASIS;
+    st->checked     = 0;
+    st->generated   = 0;
+    st->reused      = 0;
+}
+
+/**
+ * @brief       Frees the state.
+ *
+ * @param st    Pointer to the state.
+ */
+void incrFree(incrState *st){
+    freeFunctions(st->prev, st->prevCnt);
+    freeFunctions(st->cur, st->curCnt);
+    incrInit(st);
+}
+
+/**
+ * @brief       Starts hashing tokens of a function definition, called in first traverse after its ID.
+ *
+ * @param st    Pointer to the state.
+ */
+void incrBeginFunction(incrState *st){
+    st->hash = HASH_BASIS;
+    hash_tokens(&st->hash);
+}
+
+/**
+ * @brief       Finishes reading of a function definition in first traverse and records it.
+ *
+ * @param st    Pointer to the state.
+ * @param name  ID of the function.
+ * @param data  Data of the function collected in first traverse.
+ */
+void incrEndFunction(incrState *st, char *name, funData *data){
+    hash_tokens(NULL);
+
+    if(st->curCnt == st->curCap){
+        int           newCap = st->curCap == 0 ? 64 : st->curCap * 2;
+        incrFunction *tmp    = realloc(st->cur, sizeof(incrFunction) * newCap);
+        if(tmp == NULL){
+            ERROR(ERR_INTERNAL, "Malloc fail in incremental compilation.\n");
+        }
+        st->cur    = tmp;
+        st->curCap = newCap;
+    }
+
+    uint64_t signature = HASH_BASIS;
+    signature = hashBytes(signature, &data->paramNum, sizeof(data->paramNum));
+    signature = hashBytes(signature, data->paramTypes, sizeof(dataType) * data->paramNum);
+    signature = hashBytes(signature, data->paramNullable, sizeof(bool) * data->paramNum);
+    signature = hashBytes(signature, &data->returnType, sizeof(data->returnType));
+    signature = hashBytes(signature, &data->nullableRType, sizeof(data->nullableRType));
+
+    incrFunction *fun = &st->cur[st->curCnt];
+    memset(fun, 0, sizeof(incrFunction));
+    fun->name       = malloc(strlen(name) + 1);
+    fun->hash       = st->hash;
+    fun->signature  = signature;
+    fun->tree.first = AST_NONE;
+    if(fun->name == NULL){
+        ERROR(ERR_INTERNAL, "Malloc fail in incremental compilation.\n");
+    }
+    strcpy(fun->name, name);
+    st->curCnt++;
+}
+
+/**
+ * @brief       Decides which functions can be taken from the last compilation, called between traverses.
+ *
+ *              Function is reused when its tokens did not change and no function it calls changed
+ *              its signature. Nothing is reused when the set of functions changed, because names
+ *              of functions take part in checks of all bodies.
+ *
+ * @param st    Pointer to the state.
+ */
+void incrPlan(incrState *st){
+    st->secPos = 0;
+
+    bool sameNames = st->curCnt == st->prevCnt;
+    for(int i = 0; i < st->curCnt; i++){
+        st->cur[i].prevIdx = findFunction(st->prev, st->prevCnt, st->cur[i].name);
+        sameNames = sameNames && st->cur[i].prevIdx >= 0;
+    }
+
+    for(int i = 0; i < st->curCnt; i++){
+        incrFunction *fun = &st->cur[i];
+        fun->reuse = false;
+        if(!sameNames){
+            continue;
+        }
+
+        incrFunction *old = &st->prev[fun->prevIdx];
+        if(old->hash != fun->hash){
+            continue;
+        }
+
+        fun->reuse = true;
+        for(int j = 0; j < old->callCnt && fun->reuse; j++){
+            int callee = findFunction(st->cur, st->curCnt, old->calls[j]);
+            int before = findFunction(st->prev, st->prevCnt, old->calls[j]);
+            fun->reuse = st->cur[callee].signature == st->prev[before].signature;
+        }
+    }
+}
+
+/**
+ * @brief       Tells second traverse whether the body of the next function can be skipped.
+ *
+ *              When it can, functions called from the body are marked as used, as if the body was processed.
+ *
+ * @param st    Pointer to the state.
+ * @param name  ID of the function.
+ *
+ * @return      true if the function is taken from the last compilation.
+ */
+bool incrReuse(incrState *st, char *name){
+    incrFunction *fun = &st->cur[st->secPos++];
+    if(strcmp(fun->name, name) != 0){
+        fun->reuse = false;
+    }
+    if(!fun->reuse){
+        return false;
+    }
+
+    incrFunction *old = &st->prev[fun->prevIdx];
+    for(int i = 0; i < old->callCnt; i++){
+        findSymNode(funSymtable, old->calls[i])->data.used = true;
+    }
+    return true;
+}
+
+/**
+ * @brief       Marks functions reachable from main by calls, the same functions generate_code() generates.
+ *
+ * @param st        Pointer to the state, calls of all functions are collected.
+ * @param reachable reachable[i] is set to true if the i-th function is reachable.
+ * @param builtins  BUILTIN_* flags of builtin helper routines called by reachable functions are stored here.
+ *
+ * @return      true if successful, false if memory allocation fails or a called function is not defined.
+ */
+static bool incrReachable(incrState *st, bool *reachable, int *builtins){
+    int  mainIdx = findFunction(st->cur, st->curCnt, "main");
+    int *stack   = malloc(sizeof(int) * (st->curCnt + 1));
+    int  top     = 0;
+    if(stack == NULL){
+        return false;
+    }
+
+    *builtins = 0;
+    for(int i = 0; i < st->curCnt; i++){
+        reachable[i] = mainIdx < 0;
+        if(mainIdx < 0){
+            *builtins |= st->cur[i].builtins;
+        }
+    }
+    if(mainIdx >= 0){
+        reachable[mainIdx] = true;
+        stack[top++]       = mainIdx;
+    }
+
+    while(top > 0){
+        incrFunction *fun = &st->cur[stack[--top]];
+        *builtins |= fun->builtins;
+        for(int i = 0; i < fun->callCnt; i++){
+            int callee = findFunction(st->cur, st->curCnt, fun->calls[i]);
+            if(callee < 0){
+                fprintf(ERROR_OUTPUT, "\nERROR NUMBER %d: Call of function %s, which is not defined\n", ERR_INTERNAL, fun->calls[i]);
+                free(stack);
+                return false;
+            }
+            if(!reachable[callee]){
+                reachable[callee] = true;
+                stack[top++]      = callee;
+            }
+        }
+    }
+    free(stack);
+    return true;
+}
+
+/**
+ * @brief       Builds compact AST, calls and code of all functions after both traverses.
+ *
+ *              Code is generated only for functions reachable from main, unreachable
+ *              ones keep their code of the last compilation for the next one.
+ *
+ * @param st    Pointer to the state.
+ * @param out   Stream the generated code is printed to.
+ *
+ * @return      true if successful, false if code generation fails.
+ */
+static bool incrGenerate(incrState *st, FILE *out){
+    astNode *def = ASTree.root->next; // definitions of functions which were checked again, in order
+
+    for(int i = 0; i < st->curCnt; i++){
+        incrFunction *fun = &st->cur[i];
+
+        if(fun->reuse){
+            // take over everything generated last time
+            incrFunction *old = &st->prev[fun->prevIdx];
+            fun->calls       = old->calls;
+            fun->callCnt     = old->callCnt;
+            fun->builtins    = old->builtins;
+            fun->tree        = old->tree;
+            fun->code        = old->code;
+            fun->labelBase   = old->labelBase;
+            fun->labelCnt    = old->labelCnt;
+            old->calls       = NULL;
+            old->callCnt     = 0;
+            old->code        = NULL;
+            old->tree.nodes  = NULL;
+            old->tree.extra  = NULL;
+            old->tree.strtab = NULL;
+        }
+        else{
+            fun->tree.first = compactFunction(&fun->tree, def);
+            def = def->next;
+            fun->labelBase  = -1;
+            if(!collectCalls(fun)) return false;
+            st->checked++;
+        }
+    }
+
+    bool *reachable = malloc(sizeof(bool) * (st->curCnt + 1));
+    int   builtins;
+    if(reachable == NULL || !incrReachable(st, reachable, &builtins) || !generate_begin(builtins)){
+        free(reachable);
+        return false;
+    }
+
+    for(int i = 0; i < st->curCnt; i++){
+        incrFunction *fun  = &st->cur[i];
+        int           base = generated_labels();
+        if(!reachable[i]){
+            continue;
+        }
+
+        if(fun->code != NULL && fun->labelBase == base){
+            if(!generate_splice(fun->name, fun->code, fun->labelCnt)){
+                free(reachable);
+                return false;
+            }
+            st->reused++;
+            continue;
+        }
+        free(fun->code); // labels would clash with labels of other functions
+        fun->code = NULL;
+
+        fun->labelBase = base;
+        if(!generate_function(&fun->tree, fun->tree.first, &fun->code)){
+            free(reachable);
+            return false;
+        }
+        fun->labelCnt = generated_labels() - base;
+        st->generated++;
+    }
+    free(reachable);
+
+    return generate_end(out);
+}
+
+/**
+ * @brief       Compiles a program, reusing functions of the last successful compilation.
+ *
+ *              Errors do not end the compiler, their number is returned and the last
+ *              successful compilation is kept for the next call.
+ *
+ * @param st    Pointer to the state.
+ * @param input Stream with the program, it has to support rewind.
+ * @param out   Stream the generated code is printed to.
+ *
+ * @return      Exit code of the compilation.
+ */
+int incrCompile(incrState *st, FILE *input, FILE *out){
+    jmp_buf       recovery;
+    volatile bool generating = false; // functions of the last compilation are being taken over
+    if(setjmp(recovery) != 0){
+        errorRecovery = NULL;
+        incremental   = NULL;
+        hash_tokens(NULL);
+        set_input(NULL);
+        freeFunctions(st->cur, st->curCnt);
+        st->cur    = NULL;
+        st->curCnt = st->curCap = 0;
+        if(generating){
+            // code of the last compilation may have been taken over already, so none of it is kept
+            freeFunctions(st->prev, st->prevCnt);
+            st->prev    = NULL;
+            st->prevCnt = 0;
+        }
+        return errorNumber;
+    }
+
+    errorRecovery   = &recovery;
+    incremental     = st;
+    st->checked     = 0;
+    st->generated   = 0;
+    st->reused      = 0;
+
+    set_input(input);
+    reset_scanner();
+    ASTree.root = parser();
+    incremental = NULL;
+
+    // errors while lowering and generating (allocation failures) are recovered as well
+    generating = true;
+    bool ok = incrGenerate(st, out);
+
+    delete_all_allocated();
+    errorRecovery = NULL;
+    set_input(NULL);
+
+    // on failure, part of the last compilation may have been taken over already, so none of it is kept
+    freeFunctions(st->prev, st->prevCnt);
+    st->prev    = NULL;
+    st->prevCnt = 0;
+    if(!ok){
+        freeFunctions(st->cur, st->curCnt);
+    }
+    else{
+        st->prev    = st->cur;
+        st->prevCnt = st->curCnt;
+    }
+    st->cur    = NULL;
+    st->curCnt = st->curCap = 0;
+    return ok ? 0 : ERR_INTERNAL;
+}
+
+/* EOF incremental.c */
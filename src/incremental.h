@@ -0,0 +1,68 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   incremental.h
+ * 
+ * @brief  Header file for incremental recompilation of a program which is compiled repeatedly.
+ * 
+ *         Functions of the last successful compilation are kept with the hash of their tokens,
+ *         signature, called functions and generated code. When the program is compiled again,
+ *         a function is checked and generated only if its tokens changed or a function it calls
+ *         changed its signature. Code of other functions is taken from the last compilation.
+ *         Whenever a function is added or removed, everything is compiled again.
+ * 
+ * @date   19.10.2026
+*/
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "ast.h"
+#include "symtable.h"
+
+typedef struct incrFunction{
+    char      *name;
+    uint64_t   hash;       // hash of the tokens of the whole definition
+    uint64_t   signature;  // hash of types of parameters and return type
+    char     **calls;      // distinct user functions called from the body
+    int        callCnt;
+    int        builtins;   // BUILTIN_* flags of builtin helper routines called from the body
+    compactAST tree;       // the function alone, code is generated again from it when labels have to be renumbered
+    char      *code;       // generated code
+    int        labelBase;  // number of labels generated before the function, -1 if it has no code
+    int        labelCnt;
+    bool       reuse;      // code of the last compilation is used, the body is not checked again
+    int        prevIdx;    // index of the function in the last compilation, -1 if it is new
+}incrFunction;
+
+typedef struct incrState{
+    incrFunction *prev;     // functions of the last successful compilation, in order of definition
+    int           prevCnt;
+    incrFunction *cur;      // functions of the compilation in progress, collected in first traverse
+    int           curCnt;
+    int           curCap;
+    int           secPos;   // function processed in second traverse
+    uint64_t      hash;     // hash of the function being read in first traverse
+    int           checked;  // statistics of the last compilation: functions checked again,
+    int           generated; // functions with generated code (checked ones and reused ones with renumbered labels)
+    int           reused;   // and functions with code taken from the last compilation
+}incrState;
+
+/* compilation in progress, NULL unless incrCompile() runs, parser calls the functions below when set */
+extern THREAD_LOCAL incrState *incremental;
+
+void incrInit         (incrState *st);
+void incrFree         (incrState *st);
+int  incrCompile      (incrState *st, FILE *input, FILE *out);
+
+void incrBeginFunction(incrState *st);
+void incrEndFunction  (incrState *st, char *name, funData *data);
+void incrPlan         (incrState *st);
+bool incrReuse        (incrState *st, char *name);
+
+#endif //INCREMENTAL_H
+
+/* EOF incremental.h */
@@ -0,0 +1,305 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   instruction.c
+ * @brief  Implementation of streams of IFJcode24 instructions and of their printing as text.
+ *
+ * @date   19.10.2026
+ */
+#include "instruction.h"
+
+#define INSTR_INIT_CAP 256  // initial number of instructions of a stream
+
+
+/**
+ * @brief Names of the instructions, indexed by opcode.
+ */
+const char *const opcode_names[OP_CNT] = {
+    [OP_MOVE] = "MOVE", [OP_CREATEFRAME] = "CREATEFRAME", [OP_PUSHFRAME] = "PUSHFRAME",
+    [OP_POPFRAME] = "POPFRAME", [OP_DEFVAR] = "DEFVAR", [OP_CALL] = "CALL", [OP_RETURN] = "RETURN",
+    [OP_PUSHS] = "PUSHS", [OP_POPS] = "POPS", [OP_CLEARS] = "CLEARS",
+    [OP_ADD] = "ADD", [OP_SUB] = "SUB", [OP_MUL] = "MUL", [OP_DIV] = "DIV", [OP_IDIV] = "IDIV",
+    [OP_ADDS] = "ADDS", [OP_SUBS] = "SUBS", [OP_MULS] = "MULS", [OP_DIVS] = "DIVS", [OP_IDIVS] = "IDIVS",
+    [OP_LT] = "LT", [OP_GT] = "GT", [OP_EQ] = "EQ", [OP_LTS] = "LTS", [OP_GTS] = "GTS", [OP_EQS] = "EQS",
+    [OP_AND] = "AND", [OP_OR] = "OR", [OP_NOT] = "NOT", [OP_ANDS] = "ANDS", [OP_ORS] = "ORS", [OP_NOTS] = "NOTS",
+    [OP_INT2FLOAT] = "INT2FLOAT", [OP_FLOAT2INT] = "FLOAT2INT", [OP_INT2CHAR] = "INT2CHAR", [OP_STRI2INT] = "STRI2INT",
+    [OP_INT2FLOATS] = "INT2FLOATS", [OP_FLOAT2INTS] = "FLOAT2INTS", [OP_INT2CHARS] = "INT2CHARS", [OP_STRI2INTS] = "STRI2INTS",
+    [OP_READ] = "READ", [OP_WRITE] = "WRITE",
+    [OP_CONCAT] = "CONCAT", [OP_STRLEN] = "STRLEN", [OP_GETCHAR] = "GETCHAR", [OP_SETCHAR] = "SETCHAR",
+    [OP_TYPE] = "TYPE",
+    [OP_LABEL] = "LABEL", [OP_JUMP] = "JUMP", [OP_JUMPIFEQ] = "JUMPIFEQ", [OP_JUMPIFNEQ] = "JUMPIFNEQ",
+    [OP_JUMPIFEQS] = "JUMPIFEQS", [OP_JUMPIFNEQS] = "JUMPIFNEQS", [OP_EXIT] = "EXIT",
+    [OP_BREAK] = "BREAK", [OP_DPRINT] = "DPRINT",
+};
+
+/**
+ * @brief Prefixes of variables, indexed by frame.
+ */
+static const char *const frame_names[] = {[FRAME_GF] = "GF@", [FRAME_LF] = "LF@", [FRAME_TF] = "TF@"};
+
+
+/**
+ * @brief Initializes an empty instruction stream.
+ *
+ * @param code Pointer to the stream.
+ */
+void instr_init(Instr_stream *code){
+    code->code = NULL;
+    code->cnt  = 0;
+    code->cap  = 0;
+}
+
+
+/**
+ * @brief Appends an instruction to the stream.
+ *
+ * @param code Pointer to the stream.
+ * @param op Opcode of the instruction.
+ * @param a First operand, or no_operand().
+ * @param b Second operand, or no_operand().
+ * @param c Third operand, or no_operand().
+ * @return true if the instruction was added, false if memory allocation fails.
+ */
+bool instr_add(Instr_stream *code, Opcode op, Operand a, Operand b, Operand c){
+    if(code->cnt == code->cap){
+        int new_cap = code->cap == 0 ? INSTR_INIT_CAP : code->cap * 2;
+        Instruction *tmp = realloc(code->code, sizeof(Instruction) * new_cap);
+        if(tmp == NULL) return false;
+        code->code = tmp;
+        code->cap  = new_cap;
+    }
+    Instruction *instr = &code->code[code->cnt++];
+    instr->op      = op;
+    instr->args[0] = a;
+    instr->args[1] = b;
+    instr->args[2] = c;
+    return true;
+}
+
+
+/**
+ * @brief Removes all instructions from the stream, its memory is kept for next ones.
+ *
+ * @param code Pointer to the stream.
+ */
+void instr_clear(Instr_stream *code){
+    code->cnt = 0;
+}
+
+
+/**
+ * @brief Frees memory of the stream.
+ *
+ * @param code Pointer to the stream.
+ */
+void instr_free(Instr_stream *code){
+    free(code->code);
+    instr_init(code);
+}
+
+
+/**
+ * @brief Returns the maximal length of an operand as text.
+ *
+ * @param arg Operand to be measured.
+ * @param len Length of the string the operand refers to is stored here.
+ * @return Number of characters the operand can take.
+ */
+static size_t operand_bound(Operand *arg, size_t *len){
+    switch(arg->type){
+        case OPERAND_NONE:
+            return 0;
+        case OPERAND_VAR:
+        case OPERAND_USER_VAR:
+        case OPERAND_TYPE:
+        case OPERAND_FUNC:
+        case OPERAND_INTERNAL:
+            *len = strlen(arg->val.str);
+            return *len + 4;    // frame and "_", or "$$"
+        case OPERAND_LABEL:
+            *len = strlen(arg->val.str);
+            return *len + 2 + BUF_INT_LEN;
+        case OPERAND_STRING:
+            *len = strlen(arg->val.str);
+            return 4 * *len + 7;
+        case OPERAND_ARG:
+        case OPERAND_INT:
+            return 4 + BUF_INT_LEN;
+        case OPERAND_FLOAT:
+            return 6 + BUF_FLOAT_LEN;
+        case OPERAND_BOOL:
+            return 10;
+        case OPERAND_NIL:
+            return 7;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Copies n characters and returns the end of the copy.
+ */
+static char *put(char *out, const char *str, size_t n){
+    memcpy(out, str, n);
+    return out + n;
+}
+
+
+/**
+ * @brief Formats an operand as text.
+ *
+ * @param out Output of at least operand_bound() characters.
+ * @param arg Operand to be formatted.
+ * @param len Length of the string the operand refers to, measured by operand_bound().
+ * @return End of the written text.
+ */
+static char *format_operand(char *out, Operand *arg, size_t len){
+    switch(arg->type){
+        case OPERAND_NONE:
+            return out;
+        case OPERAND_VAR:
+            return put(put(out, frame_names[arg->frame], 3), arg->val.str, len);
+        case OPERAND_USER_VAR:
+            return put(put(put(out, frame_names[arg->frame], 3), "_", 1), arg->val.str, len);
+        case OPERAND_ARG:
+            out = put(put(out, frame_names[arg->frame], 3), "%", 1);
+            return out + buf_format_int(out, arg->num);
+        case OPERAND_INT:
+            out = put(out, "int@", 4);
+            return out + buf_format_int(out, arg->val.i);
+        case OPERAND_FLOAT:
+            out = put(out, "float@", 6);
+            return out + buf_format_float(out, arg->val.f);
+        case OPERAND_BOOL:
+            return arg->val.b ? put(out, "bool@true", 9) : put(out, "bool@false", 10);
+        case OPERAND_NIL:
+            return put(out, "nil@nil", 7);
+        case OPERAND_STRING:
+            out = put(out, "string@", 7);
+            return out + buf_format_string(out, arg->val.str, len);
+        case OPERAND_TYPE:
+            return put(out, arg->val.str, len);
+        case OPERAND_LABEL:
+            out = put(put(put(out, "&", 1), arg->val.str, len), "-", 1);
+            return out + buf_format_int(out, arg->num);
+        case OPERAND_FUNC:
+            return put(put(out, "$", 1), arg->val.str, len);
+        case OPERAND_INTERNAL:
+            return put(put(out, "$$", 2), arg->val.str, len);
+    }
+    return out;
+}
+
+
+/**
+ * @brief Adds an instruction as a line of text to the current section of the buffer.
+ *
+ *        Room for the longest possible line is reserved at once, the line is formatted in place.
+ *
+ * @param buf Pointer to the buffer linked list.
+ * @param instr Instruction to be printed.
+ * @return true if the operation was successful, false otherwise.
+ */
+bool instr_print_one(Buffer_ll *buf, Instruction *instr){
+    const char *name = opcode_names[instr->op];
+    size_t name_len  = strlen(name);
+    size_t lens[INSTR_OPERANDS] = {0};
+    size_t bound     = name_len + 1;    // newline
+    for(int i = 0; i < INSTR_OPERANDS; i++){
+        bound += 1 + operand_bound(&instr->args[i], &lens[i]);
+    }
+    if(!buf_reserve(buf, bound)) return false;
+
+    char *start = buf->page->data + buf->page->used;
+    char *out   = put(start, name, name_len);
+    for(int i = 0; i < INSTR_OPERANDS && instr->args[i].type != OPERAND_NONE; i++){
+        *out++ = ' ';
+        out = format_operand(out, &instr->args[i], lens[i]);
+    }
+    *out++ = '\n';
+    buf->page->used += out - start;
+    return buf_push(buf);
+}
+
+
+/**
+ * @brief Adds all instructions of the stream as text to the current section of the buffer.
+ *
+ * @param buf Pointer to the buffer linked list.
+ * @param code Pointer to the stream.
+ * @return true if the operation was successful, false otherwise.
+ */
+bool instr_print(Buffer_ll *buf, Instr_stream *code){
+    for(int i = 0; i < code->cnt; i++){
+        if(!instr_print_one(buf, &code->code[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks whether an instruction works with the data stack.
+ *
+ * @param op Opcode of the instruction.
+ * @return true for stack instructions (PUSHS, POPS, CLEARS and the ones with S suffix), false otherwise.
+ */
+bool instr_uses_stack(Opcode op){
+    switch(op){
+        case OP_PUSHS: case OP_POPS: case OP_CLEARS:
+        case OP_ADDS: case OP_SUBS: case OP_MULS: case OP_DIVS: case OP_IDIVS:
+        case OP_LTS: case OP_GTS: case OP_EQS: case OP_ANDS: case OP_ORS: case OP_NOTS:
+        case OP_INT2FLOATS: case OP_FLOAT2INTS: case OP_INT2CHARS: case OP_STRI2INTS:
+        case OP_JUMPIFEQS: case OP_JUMPIFNEQS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * @brief Counts instructions of the stream.
+ *
+ * @param code Pointer to the stream.
+ * @param opcodes Numbers of instructions per opcode, instructions of the stream are added to them.
+ * @return Number of instructions.
+ */
+long instr_count(Instr_stream *code, long *opcodes){
+    for(int i = 0; i < code->cnt; i++){
+        opcodes[code->code[i].op]++;
+    }
+    return code->cnt;
+}
+
+
+/**
+ * @brief Counts instructions of code in text form, one instruction per line.
+ *
+ *        Empty lines, comments and the header line are skipped.
+ *
+ * @param text Code to be counted.
+ * @param opcodes Numbers of instructions per opcode, instructions of the code are added to them.
+ * @return Number of instructions.
+ */
+long instr_count_text(const char *text, long *opcodes){
+    long cnt = 0;
+    while(*text != '\0'){
+        while(*text == ' ' || *text == '\t'){
+            text++;
+        }
+        size_t len = strcspn(text, " \t\r\n#");
+        for(int op = 0; len > 0 && op < OP_CNT; op++){
+            if(strncmp(text, opcode_names[op], len) == 0 && opcode_names[op][len] == '\0'){
+                opcodes[op]++;
+                cnt++;
+                break;
+            }
+        }
+        text += strcspn(text, "\n");
+        if(*text == '\n'){
+            text++;
+        }
+    }
+    return cnt;
+}
+
+/* EOF instruction.c */
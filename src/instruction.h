@@ -0,0 +1,136 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ *
+ * @file   instruction.h
+ * @brief  Header file for the in-memory representation of IFJcode24 instructions.
+ *         The code generator appends instructions with typed operands to a stream,
+ *         which is printed as text to the code buffer when the function is finished.
+ *
+ * @date   19.10.2026
+ */
+
+#ifndef INSTRUCTION_H
+#define INSTRUCTION_H
+#include <stdbool.h>
+#include "code_buffer.h"
+
+/**
+ * @brief Opcodes of all IFJcode24 instructions, in order of the language specification.
+ */
+typedef enum {
+    // Frames and function calls
+    OP_MOVE, OP_CREATEFRAME, OP_PUSHFRAME, OP_POPFRAME, OP_DEFVAR, OP_CALL, OP_RETURN,
+    // Data stack
+    OP_PUSHS, OP_POPS, OP_CLEARS,
+    // Arithmetic, relational, boolean and conversion instructions
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_IDIV,
+    OP_ADDS, OP_SUBS, OP_MULS, OP_DIVS, OP_IDIVS,
+    OP_LT, OP_GT, OP_EQ, OP_LTS, OP_GTS, OP_EQS,
+    OP_AND, OP_OR, OP_NOT, OP_ANDS, OP_ORS, OP_NOTS,
+    OP_INT2FLOAT, OP_FLOAT2INT, OP_INT2CHAR, OP_STRI2INT,
+    OP_INT2FLOATS, OP_FLOAT2INTS, OP_INT2CHARS, OP_STRI2INTS,
+    // Input and output
+    OP_READ, OP_WRITE,
+    // Strings
+    OP_CONCAT, OP_STRLEN, OP_GETCHAR, OP_SETCHAR,
+    // Types
+    OP_TYPE,
+    // Program flow
+    OP_LABEL, OP_JUMP, OP_JUMPIFEQ, OP_JUMPIFNEQ, OP_JUMPIFEQS, OP_JUMPIFNEQS, OP_EXIT,
+    // Debugging
+    OP_BREAK, OP_DPRINT,
+    OP_CNT      // number of opcodes
+} Opcode;
+
+/**
+ * @brief Types of instruction operands.
+ */
+typedef enum {
+    OPERAND_NONE,       // unused operand
+    OPERAND_VAR,        // variable defined by the compiler, printed as FRAME@name
+    OPERAND_USER_VAR,   // variable of the program, printed as FRAME@_name
+    OPERAND_ARG,        // argument of a call, printed as FRAME@%number
+    OPERAND_INT,
+    OPERAND_FLOAT,
+    OPERAND_BOOL,
+    OPERAND_NIL,
+    OPERAND_STRING,
+    OPERAND_TYPE,       // type name of READ
+    OPERAND_LABEL,      // label inside of a function, printed as &name-number
+    OPERAND_FUNC,       // label of a function of the program, printed as $name
+    OPERAND_INTERNAL    // label of a builtin function or of the end of the program, printed as $$name
+} Operand_type;
+
+typedef enum {FRAME_GF, FRAME_LF, FRAME_TF} Frame;
+
+/**
+ * @struct Operand
+ * @brief  Represents an operand of an instruction.
+ *
+ * Strings the operand refers to (names, literals) are not copied, they have to live
+ * until the instruction is printed.
+ */
+typedef struct {
+    Operand_type type;
+    Frame frame;    ///< Frame of a variable
+    int num;        ///< Frame slot of a variable (-1 if it has none), number of an argument or a label
+    union {
+        int i;
+        double f;
+        bool b;
+        const char *str;    ///< Name of a variable or a label, string literal, name of a type
+    } val;
+} Operand;
+
+#define INSTR_OPERANDS 3    // maximal number of operands of an instruction
+
+/**
+ * @struct Instruction
+ * @brief  Represents one instruction, unused operands are of type OPERAND_NONE.
+ */
+typedef struct {
+    Opcode op;
+    Operand args[INSTR_OPERANDS];
+} Instruction;
+
+/**
+ * @struct Instr_stream
+ * @brief  Represents a growing sequence of instructions.
+ */
+typedef struct {
+    Instruction *code;  ///< Instructions in order of execution
+    int cnt;            ///< Number of instructions
+    int cap;            ///< Allocated number of instructions
+} Instr_stream;
+
+// Constructors of operands
+#define no_operand()                 ((Operand){.type = OPERAND_NONE})
+#define var_operand(fr, slot, name)  ((Operand){.type = OPERAND_VAR, .frame = (fr), .num = (slot), .val.str = (name)})
+#define user_var_operand(slot, name) ((Operand){.type = OPERAND_USER_VAR, .frame = FRAME_TF, .num = (slot), .val.str = (name)})
+#define arg_operand(fr, n)           ((Operand){.type = OPERAND_ARG, .frame = (fr), .num = (n)})
+#define int_operand(v)               ((Operand){.type = OPERAND_INT, .val.i = (v)})
+#define float_operand(v)             ((Operand){.type = OPERAND_FLOAT, .val.f = (v)})
+#define bool_operand(v)              ((Operand){.type = OPERAND_BOOL, .val.b = (v)})
+#define nil_operand()                ((Operand){.type = OPERAND_NIL})
+#define string_operand(s)            ((Operand){.type = OPERAND_STRING, .val.str = (s)})
+#define type_operand(name)           ((Operand){.type = OPERAND_TYPE, .val.str = (name)})
+#define label_operand(name, n)       ((Operand){.type = OPERAND_LABEL, .num = (n), .val.str = (name)})
+#define func_operand(name)           ((Operand){.type = OPERAND_FUNC, .val.str = (name)})
+#define internal_operand(name)       ((Operand){.type = OPERAND_INTERNAL, .val.str = (name)})
+
+extern const char *const opcode_names[OP_CNT];
+
+// Function prototypes for instruction streams
+void instr_init(Instr_stream *code);
+bool instr_add(Instr_stream *code, Opcode op, Operand a, Operand b, Operand c);
+void instr_clear(Instr_stream *code);
+void instr_free(Instr_stream *code);
+bool instr_print_one(Buffer_ll *buf, Instruction *instr);
+bool instr_print(Buffer_ll *buf, Instr_stream *code);
+bool instr_uses_stack(Opcode op);
+long instr_count(Instr_stream *code, long *opcodes);
+long instr_count_text(const char *text, long *opcodes);
+
+#endif // INSTRUCTION_H
+
+/* EOF instruction.h */
@@ -12,18 +12,552 @@
  * @date   21.11.2024
 */
 
+#define _POSIX_C_SOURCE 200809L // fmemopen, nanosleep
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "ast_file.h"
+#include "batch.h"
+#include "compile_cache.h"
+#include "compile_server.h"
+#include "file_io.h"
 #include "code_generator.h"
 #include "parser.h"
 #include "scanner.h"
 
-AST   ASTree; 
-Token currentToken;
+#define USAGE \
+    "Usage: %s [-o OUTPUT] [--emit-ast FILE | --from-ast FILE] [--cache DIR [--cache-size BYTES]] [--stats] [PROGRAM]\n" \
+    "  PROGRAM             program to compile (default standard input)\n" \
+    "  -o OUTPUT           file the generated code is written to (default standard output),\n" \
+    "                      it is removed when the compilation fails\n" \
+    "  --emit-ast FILE     also store the checked AST to FILE\n" \
+    "  --from-ast FILE     generate code from AST stored in FILE, without reading the program\n" \
+    "  --cache DIR         reuse code generated for the same program, stored in DIR\n" \
+    "  --cache-size BYTES  bound of the size of the cache (default 64 MiB)\n" \
+    "  --stats             print size of the generated code and numbers of instructions per opcode,\n" \
+    "                      function and builtin helper to standard error output\n" \
+    "Usage: %s --watch SOURCE OUTPUT\n" \
+    "  compile SOURCE to OUTPUT whenever it changes, only changed functions are compiled again\n" \
+    "Usage: %s --server SOCKET\n" \
+    "  compile programs sent to UNIX socket SOCKET, until killed\n" \
+    "Usage: %s --client SOCKET <program.ifj >program.ifjcode\n" \
+    "  compile the program by the server listening on SOCKET\n" \
+    "Usage: %s [-j N | --jobs N] --batch PROGRAM... | --batch-list MANIFEST\n" \
+    "  compile every PROGRAM (or every program listed in MANIFEST) to PROGRAM.ifjcode on N threads\n" \
+    "  (default number of processors), exit codes of programs are printed to standard output\n"
+
+#define WATCH_INTERVAL_MS  200
+#define MAX_CACHE_SIZE     ((unsigned long long)SIZE_MAX)
+#define OUTPUT_BUFFER_SIZE (1 << 20) // generated code is written in blocks of this size
+
+typedef enum{
+    MODE_COMPILE,       // compile one program (default)
+    MODE_WATCH,         // --watch
+    MODE_SERVER,        // --server
+    MODE_CLIENT,        // --client
+    MODE_BATCH,         // --batch
+    MODE_BATCH_LIST     // --batch-list
+}compilerMode;
+
+// state of the compilation, which has to be released when an error in the program ends it
+static compactAST   programTree;
+static compileCache programCache;
+static FILE        *cacheEntry = NULL;
+
+/**
+ * @brief  Generates code from AST file written by an earlier run with --emit-ast.
+ * 
+ * @param path Path of the AST file.
+ * @param out  Stream the generated code is printed to.
+ * 
+ * @return Exit code of the compiler.
+ */
+static int compileFromAST(char *path, FILE *out){
+    astFile file;
+    if(!loadASTFile(&file, path)){
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot load AST file %s\n", ERR_INTERNAL, path);
+        return ERR_INTERNAL;
+    }
+    bool ok = generate_code(&file.tree, out);
+    unloadASTFile(&file);
+    return ok ? 0 : ERR_INTERNAL;
+}
+
+/**
+ * @brief  Compiles the program, using code stored in the cache for the same program.
+ * 
+ *         Only successful compilations are stored, errors end the compiler before the entry is created.
+ * 
+ * @param in      Stream with the program.
+ * @param out     Stream the generated code is printed to.
+ * @param dir     Directory of the cache.
+ * @param maxSize Bound of the size of the cache in bytes.
+ * 
+ * @return Exit code of the compiler.
+ */
+static int compileCached(FILE *in, FILE *out, char *dir, size_t maxSize){
+    size_t len;
+    char  *source = readAll(in, &len);
+    if(source == NULL){
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot read the program\n", ERR_INTERNAL);
+        return ERR_INTERNAL;
+    }
+
+    if(cacheInit(&programCache, dir, maxSize)){
+        cacheKey(&programCache, source, len);
+        cacheResult found = cacheLookup(&programCache, out);
+        if(found != CACHE_MISS){
+            free(source);
+            if(found == CACHE_FAILED){
+                fprintf(stderr, "\nERROR NUMBER %d: Cannot print the cached code\n", ERR_INTERNAL);
+                return ERR_INTERNAL;
+            }
+            return 0;
+        }
+    }
+    else{
+        fprintf(stderr, "Cannot use cache directory %s\n", dir);
+        programCache.dir = NULL;
+    }
+
+    // scanner rewinds its input, so it reads the program from memory instead of the stream
+    FILE *input = fmemopen(source, len, "r");
+    if(input == NULL){
+        free(source);
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot read the program\n", ERR_INTERNAL);
+        return ERR_INTERNAL;
+    }
+    set_input(input);
+
+    ASTree.root = parser();
+
+    buildCompactAST(&programTree, ASTree.root);
+
+    cacheEntry = programCache.dir != NULL ? cacheBegin(&programCache) : NULL;
+    bool ok;
+    if(cacheEntry == NULL){
+        ok = generate_code(&programTree, out);
+    }
+    else if(generate_code(&programTree, cacheEntry)){
+        ok = cacheCommit(&programCache, cacheEntry, out);
+    }
+    else{
+        cacheAbort(&programCache, cacheEntry);
+        ok = false;
+    }
+    cacheEntry = NULL;
 
-int main(){
+    freeCompactAST(&programTree);
+    delete_all_allocated();
+    set_input(NULL);
+    fclose(input);
+    free(source);
+    return ok ? 0 : ERR_INTERNAL;
+}
+
+/**
+ * @brief  Compiles the program.
+ * 
+ * @param in      Stream with the program, it has to support rewind.
+ * @param out     Stream the generated code is printed to.
+ * @param emitAST Path the checked AST is also stored to, NULL if it is not stored.
+ * 
+ * @return Exit code of the compiler.
+ */
+static int compile(FILE *in, FILE *out, char *emitAST){
+    set_input(in);
     ASTree.root = parser();
-    generate_code(ASTree.root);
+
+    buildCompactAST(&programTree, ASTree.root);
+
+    int ret = 0;
+    if(emitAST != NULL && !saveASTFile(&programTree, emitAST)){
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot write AST file %s\n", ERR_INTERNAL, emitAST);
+        ret = ERR_INTERNAL;
+    }
+
+    if(!generate_code(&programTree, out)){
+        ret = ERR_INTERNAL;
+    }
+    freeCompactAST(&programTree);
     delete_all_allocated();
+    set_input(NULL);
+    return ret;
+}
+
+/**
+ * @brief  Runs the compilation selected by the options, errors in the program come back here.
+ * 
+ * @param in        Stream with the program, NULL when the code is generated from AST file.
+ * @param out       Stream the generated code is printed to.
+ * @param fromAST   Path of the AST file the code is generated from, NULL if the program is compiled.
+ * @param emitAST   Path the checked AST is also stored to, NULL if it is not stored.
+ * @param cacheDir  Directory of the cache, NULL if the cache is not used.
+ * @param cacheSize Bound of the size of the cache in bytes.
+ * 
+ * @return Exit code of the compiler.
+ */
+static int compileRecovering(FILE *in, FILE *out, char *fromAST, char *emitAST, char *cacheDir, size_t cacheSize){
+    jmp_buf recovery;
+    if(setjmp(recovery) != 0){
+        errorRecovery = NULL;
+        freeCompactAST(&programTree);
+        if(cacheEntry != NULL){ // partial entry must not stay in the cache
+            cacheAbort(&programCache, cacheEntry);
+            cacheEntry = NULL;
+        }
+        set_input(NULL);
+        return errorNumber;
+    }
+    errorRecovery = &recovery;
+
+    int ret;
+    if(fromAST != NULL){
+        ret = compileFromAST(fromAST, out);
+    }
+    else if(cacheDir != NULL && emitAST == NULL){ // AST is not built on a cache hit
+        ret = compileCached(in, out, cacheDir, cacheSize);
+    }
+    else{
+        ret = compile(in, out, emitAST);
+    }
+    errorRecovery = NULL;
+    return ret;
+}
+
+/**
+ * @brief  Opens the program so that the scanner can rewind it.
+ * 
+ *         Pipes and terminals can not be rewound, so they are read into memory first.
+ * 
+ * @param path   Path of the program, standard input is used when NULL.
+ * @param source Pointer where the program read into memory is stored, NULL if it is not.
+ * 
+ * @return Stream with the program, NULL if it can not be read.
+ */
+static FILE *openInput(char *path, char **source){
+    *source = NULL;
+    FILE *in = path != NULL ? fopen(path, "r") : stdin;
+    if(in == NULL){
+        return NULL;
+    }
+
+    struct stat st;
+    if(fstat(fileno(in), &st) == 0 && S_ISREG(st.st_mode)){
+        return in;
+    }
+
+    size_t len;
+    *source = readAll(in, &len);
+    if(in != stdin){
+        fclose(in);
+    }
+    if(*source == NULL){
+        return NULL;
+    }
+    if(len == 0){ // fmemopen does not accept empty buffers everywhere
+        (*source)[len++] = ' ';
+    }
+    return fmemopen(*source, len, "r");
+}
+
+/**
+ * @brief  Finishes writing of the generated code, output file of a failed compilation is removed.
+ * 
+ * @param out  Stream the generated code was printed to.
+ * @param path Path of the output file, NULL for standard output.
+ * @param ret  Exit code of the compilation.
+ * 
+ * @return Exit code of the compiler.
+ */
+static int closeOutput(FILE *out, char *path, int ret){
+    if((path != NULL ? fclose(out) : fflush(out)) != 0 && ret == 0){
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot write the generated code\n", ERR_INTERNAL);
+        ret = ERR_INTERNAL;
+    }
+    if(path != NULL && ret != 0){
+        unlink(path);
+    }
+    return ret;
+}
+
+/**
+ * @brief  Compiles the program again whenever its file changes, until the compiler is killed.
+ * 
+ *         Errors are reported and the compiler waits for the next change, OUTPUT is only
+ *         replaced by code of a successful compilation.
+ * 
+ * @param source Path of the program.
+ * @param output Path of the generated code.
+ * 
+ * @return Exit code of the compiler, if watching can not start.
+ */
+static int watch(char *source, char *output){
+    char tmpPath[CACHE_PATH_LEN];
+    if(snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", output) >= (int)sizeof(tmpPath)){
+        fprintf(stderr, "\nERROR NUMBER %d: Path %s is too long\n", ERR_INTERNAL, output);
+        return ERR_INTERNAL;
+    }
+
+    incrState state;
+    incrInit(&state);
+
+    struct stat     last  = {0};
+    struct timespec sleep = {.tv_sec = 0, .tv_nsec = WATCH_INTERVAL_MS * 1000000L};
+    while(true){
+        struct stat st;
+        if(stat(source, &st) != 0
+           || (st.st_mtim.tv_sec == last.st_mtim.tv_sec && st.st_mtim.tv_nsec == last.st_mtim.tv_nsec
+               && st.st_size == last.st_size && st.st_ino == last.st_ino)){
+            nanosleep(&sleep, NULL);
+            continue;
+        }
+        last = st;
+
+        FILE *in  = fopen(source, "r");
+        FILE *out = fopen(tmpPath, "w");
+        if(in == NULL || out == NULL){
+            fprintf(stderr, "\nERROR NUMBER %d: Cannot open %s\n", ERR_INTERNAL, in == NULL ? source : tmpPath);
+            if(in != NULL) fclose(in);
+            if(out != NULL) fclose(out);
+            continue;
+        }
+
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        int ret = incrCompile(&state, in, out);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        fclose(in);
+
+        if(fclose(out) == 0 && ret == 0 && rename(tmpPath, output) == 0){
+            fprintf(stderr, "%s: %d functions checked, %d generated, %d reused (%.1f ms)\n",
+                    source, state.checked, state.generated, state.reused,
+                    (end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) / 1e6);
+        }
+        else{
+            unlink(tmpPath);
+            fprintf(stderr, "%s: compilation failed with %d\n", source, ret != 0 ? ret : ERR_INTERNAL);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Parses a decimal number of an option.
+ * 
+ * @param str Argument of the option.
+ * @param max Greatest valid number.
+ * @param num Pointer where the number is stored.
+ * 
+ * @return true if the whole argument is a number from 0 to max, false otherwise.
+ */
+static bool parseNumber(const char *str, unsigned long long max, unsigned long long *num){
+    if(str[0] < '0' || str[0] > '9'){ // strtoull() would also accept white space and a sign
+        return false;
+    }
+    char *end;
+    errno = 0;
+    *num = strtoull(str, &end, 10);
+    return errno == 0 && *end == '\0' && *num <= max;
+}
+
+/**
+ * @brief  Runs a mode which does not compile a single program.
+ * 
+ * @param mode     Mode selected by the options.
+ * @param arg      Argument of the mode option (socket, manifest or source of --watch).
+ * @param output   Output of --watch.
+ * @param programs Programs of --batch.
+ * @param cnt      Number of programs of --batch.
+ * @param jobs     Number of threads of the batch modes, number of processors when 0.
+ * 
+ * @return Exit code of the compiler.
+ */
+static int runMode(compilerMode mode, char *arg, char *output, char **programs, int cnt, int jobs){
+    switch(mode){
+        case MODE_WATCH:
+            return watch(arg, output);
+        case MODE_SERVER:
+            return runServer(arg);
+        case MODE_CLIENT:
+            return runClient(arg);
+        case MODE_BATCH:
+            return runBatch(programs, cnt, jobs);
+        case MODE_BATCH_LIST: {
+            char **paths = readManifest(arg, &cnt);
+            if(paths == NULL){
+                fprintf(stderr, "\nERROR NUMBER %d: Cannot read manifest %s\n", ERR_INTERNAL, arg);
+                return ERR_INTERNAL;
+            }
+            int ret = runBatch(paths, cnt, jobs);
+            freeManifest(paths, cnt);
+            return ret;
+        }
+        default:
+            return ERR_INTERNAL;
+    }
+}
+
+int main(int argc, char **argv){
+    char *input = NULL;
+    char *output = NULL;
+    char *emitAST = NULL;
+    char *fromAST = NULL;
+    char *cacheDir = NULL;
+    size_t cacheSize = CACHE_DEFAULT_SIZE;
+    bool printStats = false;
+
+    // options are parsed first, so their order does not matter; then the selected mode is run
+    compilerMode mode = MODE_COMPILE;
+    char        *modeArg = NULL, *watchOutput = NULL;
+    char       **programs = malloc(sizeof(char *) * argc); // programs of --batch, or the one compiled program
+    int          programCnt = 0, jobs = 0;
+    bool         valid = programs != NULL, jobsSet = false, cacheSizeSet = false;
+    unsigned long long num;
+
+    for(int i = 1; valid && i < argc; i++){
+        if(strcmp(argv[i], "-o") == 0 && i + 1 < argc){
+            output = argv[++i];
+        }
+        else if(strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0){
+            printf(USAGE, argv[0], argv[0], argv[0], argv[0], argv[0]);
+            free(programs);
+            return 0;
+        }
+        else if(strcmp(argv[i], "--emit-ast") == 0 && i + 1 < argc){
+            emitAST = argv[++i];
+        }
+        else if(strcmp(argv[i], "--from-ast") == 0 && i + 1 < argc){
+            fromAST = argv[++i];
+        }
+        else if(strcmp(argv[i], "--watch") == 0 && i + 2 < argc && mode == MODE_COMPILE){
+            mode        = MODE_WATCH;
+            modeArg     = argv[++i];
+            watchOutput = argv[++i];
+        }
+        else if(strcmp(argv[i], "--server") == 0 && i + 1 < argc && mode == MODE_COMPILE){
+            mode    = MODE_SERVER;
+            modeArg = argv[++i];
+        }
+        else if(strcmp(argv[i], "--client") == 0 && i + 1 < argc && mode == MODE_COMPILE){
+            mode    = MODE_CLIENT;
+            modeArg = argv[++i];
+        }
+        else if(strcmp(argv[i], "--batch") == 0 && mode == MODE_COMPILE){
+            mode = MODE_BATCH;
+        }
+        else if(strcmp(argv[i], "--batch-list") == 0 && i + 1 < argc && mode == MODE_COMPILE){
+            mode    = MODE_BATCH_LIST;
+            modeArg = argv[++i];
+        }
+        else if((strcmp(argv[i], "--jobs") == 0 || strcmp(argv[i], "-j") == 0) && i + 1 < argc){
+            valid   = parseNumber(argv[++i], INT_MAX, &num) && num > 0;
+            jobs    = (int)num;
+            jobsSet = true;
+        }
+        else if(strcmp(argv[i], "--cache") == 0 && i + 1 < argc){
+            cacheDir = argv[++i];
+        }
+        else if(strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc){
+            valid        = parseNumber(argv[++i], MAX_CACHE_SIZE, &num);
+            cacheSize    = (size_t)num;
+            cacheSizeSet = true;
+        }
+        else if(strcmp(argv[i], "--stats") == 0){
+            printStats = true;
+        }
+        else if(argv[i][0] != '-'){
+            programs[programCnt++] = argv[i];
+        }
+        else{
+            valid = false;
+        }
+    }
+
+    // options which do not apply to the selected mode are rejected instead of being ignored
+    bool compileOptions = output != NULL || emitAST != NULL || fromAST != NULL || cacheDir != NULL
+                       || cacheSizeSet || printStats;
+    switch(mode){
+        case MODE_COMPILE:
+            valid = valid && !jobsSet && programCnt <= 1 && (cacheDir != NULL || !cacheSizeSet)
+                 && (fromAST == NULL || (emitAST == NULL && cacheDir == NULL && programCnt == 0));
+            break;
+        case MODE_BATCH:
+            valid = valid && !compileOptions;
+            break;
+        case MODE_BATCH_LIST:
+            valid = valid && !compileOptions && programCnt == 0;
+            break;
+        default:
+            valid = valid && !compileOptions && !jobsSet && programCnt == 0;
+            break;
+    }
+    if(!valid){
+        fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0], argv[0]);
+        free(programs);
+        return ERR_INTERNAL;
+    }
+    if(mode != MODE_COMPILE){
+        int ret = runMode(mode, modeArg, watchOutput, programs, programCnt, jobs);
+        free(programs);
+        return ret;
+    }
+    input = programCnt > 0 ? programs[0] : NULL;
+    free(programs);
+
+    char *source = NULL;
+    FILE *in     = NULL;
+    if(fromAST == NULL){
+        // cached compilation reads the program into memory itself
+        in = (cacheDir != NULL && emitAST == NULL) ? (input != NULL ? fopen(input, "r") : stdin) : openInput(input, &source);
+        if(in == NULL){
+            fprintf(stderr, "\nERROR NUMBER %d: Cannot read the program %s\n", ERR_INTERNAL, input != NULL ? input : "");
+            free(source);
+            return ERR_INTERNAL;
+        }
+    }
+
+    FILE *out = output != NULL ? fopen(output, "w") : stdout;
+    if(out == NULL){
+        fprintf(stderr, "\nERROR NUMBER %d: Cannot open %s\n", ERR_INTERNAL, output);
+        if(in != NULL && in != stdin) fclose(in);
+        free(source);
+        return ERR_INTERNAL;
+    }
+    setvbuf(out, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+    Code_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    if(printStats){
+        generate_stats(&stats);
+    }
+
+    // errors in the program come back to compileRecovering(), so the output file can be removed
+    int ret = compileRecovering(in, out, fromAST, emitAST, cacheDir, cacheSize);
+    generate_stats(NULL);
+
+    ret = closeOutput(out, output, ret);
+    if(printStats && ret == 0){
+        if(stats.part_cnt == 0){
+            fprintf(stderr, "Generated code was taken from the cache\n");
+        }
+        else{
+            print_code_stats(&stats, stderr);
+        }
+    }
+    free_code_stats(&stats);
+    if(in != NULL && in != stdin){
+        fclose(in);
+    }
+    free(source);
+    return ret;
 }
 
 /* EOF main.c */
\ No newline at end of file
@@ -25,6 +25,11 @@
 
 #include "parser.h"
 
+THREAD_LOCAL AST   ASTree;
+THREAD_LOCAL Token currentToken;
+
+THREAD_LOCAL symtable *frameSlots = NULL; // frame slots of variables in the currently processed function, keyed by name
+
 /**
  * @brief               Processes the program.
  * 
@@ -56,7 +61,7 @@ bool prog(bool firstTraverse){
 
     mainDefined(); // check if main function is defined and has correct data
     if(!firstTraverse){
-        allUsed(funSymtable->rootPtr); // check if all functions defined were also used in program
+        allUsed(funSymtable); // check if all functions defined were also used in program
     }
     
     return true;
@@ -161,12 +166,12 @@ bool def_func_first(symNode *functionEntry, char *funID){
     
     funData   entryData;
     symData   entrySymData;
-    dataType *paramTypes     = malloc(sizeof(dataType)*MAX_PARAM_NUM);
-    char    **paramNames     = malloc(sizeof(char *)*MAX_PARAM_NUM);
-    bool     *paramNullable  = malloc(sizeof(bool)*MAX_PARAM_NUM);
-    if(paramTypes == NULL || paramNames == NULL || paramNullable == NULL){
-        ERROR(ERR_INTERNAL,"Malloc fail in def_func.\n");
-    }
+    dataType  paramTypesArr[MAX_PARAM_NUM]; // on stack, so nothing is lost when an error interrupts parsing
+    char     *paramNamesArr[MAX_PARAM_NUM];
+    bool      paramNullableArr[MAX_PARAM_NUM];
+    dataType *paramTypes     = paramTypesArr;
+    char    **paramNames     = paramNamesArr;
+    bool     *paramNullable  = paramNullableArr;
     int       paramNum = 0;
     dataType  returnType;
     bool      nullable;
@@ -174,6 +179,10 @@ bool def_func_first(symNode *functionEntry, char *funID){
     if(functionEntry != NULL){
         ERROR(ERR_SEM_REDEF, "Redefining function (%s) is not allowed.\n",funID);
     }
+
+    if(incremental != NULL){
+        incrBeginFunction(incremental);
+    }
     
     symtable *symtableNewF = createSymtable();
     push(&symtableStack, symtableNewF);
@@ -201,14 +210,18 @@ bool def_func_first(symNode *functionEntry, char *funID){
     }
     entryData.tbPtr         = pop(&symtableStack);
     entryData.defined       = true;
-    entryData.paramNames    = paramNames;
-    entryData.paramTypes    = paramTypes;
-    entryData.paramNullable = paramNullable;
+    entryData.paramNames    = arenaAlloc(&compileArena, sizeof(char *) * paramNum);
+    entryData.paramTypes    = arenaAlloc(&compileArena, sizeof(dataType) * paramNum);
+    entryData.paramNullable = arenaAlloc(&compileArena, sizeof(bool) * paramNum);
+    memcpy(entryData.paramNames, paramNames, sizeof(char *) * paramNum);
+    memcpy(entryData.paramTypes, paramTypes, sizeof(dataType) * paramNum);
+    memcpy(entryData.paramNullable, paramNullable, sizeof(bool) * paramNum);
     entryData.nullableRType = nullable;
     entryData.returnType    = returnType;
     entryData.paramNum      = paramNum;
+    entryData.frameSize     = paramNum; // variables of the body are counted in second traverse
 
-    entrySymData.data.fData = entryData;
+    entrySymData.data.fData = createFunData(entryData);
     entrySymData.varOrFun   = 1;
 
     if(strcmp(funID, "main") == 0){
@@ -226,6 +239,10 @@ bool def_func_first(symNode *functionEntry, char *funID){
         GT
     }
 
+    if(incremental != NULL){
+        incrEndFunction(incremental, funID, entrySymData.data.fData);
+    }
+
     return true;
 
 }
@@ -252,14 +269,21 @@ bool def_func_first(symNode *functionEntry, char *funID){
  */
 bool def_func_sec(symNode *functionEntry, char *funID){
 
+    if(incremental != NULL && incrReuse(incremental, funID)){ // unchanged since the last compilation
+        while(currentToken.type != tokentype_kw_pub && currentToken.type != tokentype_EOF){
+            GT
+        }
+        return true;
+    }
+
     astNode  *funcAstNode   = createAstNode();  // allocate node with no representation yet
     astNode  *bodyAstRoot   = createRootNode(); // create root node for body (statements in body will be connected to this)
 
-    symtable *symtableFun   = functionEntry->data.data.fData.tbPtr;
+    symtable *symtableFun   = functionEntry->data.data.fData->tbPtr;
     dataType  returnType    = getReturnType(funID);
-    char    **paramNames    = functionEntry->data.data.fData.paramNames;
-    int       paramNum      = functionEntry->data.data.fData.paramNum;
-    bool      nullableRType = functionEntry->data.data.fData.nullableRType;
+    char    **paramNames    = functionEntry->data.data.fData->paramNames;
+    int       paramNum      = functionEntry->data.data.fData->paramNum;
+    bool      nullableRType = functionEntry->data.data.fData->nullableRType;
     bool      inMain        = (strcmp(funID, "main") == 0); 
 
     while(currentToken.type != tokentype_lcbracket){ // skip the function header (already processed in first traverse)
@@ -268,6 +292,11 @@ bool def_func_sec(symNode *functionEntry, char *funID){
 
     GT
 
+    frameSlots = createSymtable();
+    for(int i = 0; i < paramNum; i++){
+        frameSlot(paramNames[i]);
+    }
+
     push(&symtableStack, symtableFun);
 
     body(returnType,nullableRType, bodyAstRoot, inMain);
@@ -277,7 +306,12 @@ bool def_func_sec(symNode *functionEntry, char *funID){
 
     symtableFun = pop(&symtableStack);
 
-    allUsed(symtableFun->rootPtr); // perform semantic check of used variables
+    int frameSize = frameSlots->nodeCnt;
+    functionEntry->data.data.fData->frameSize = frameSize;
+    deleteSymtable(frameSlots);
+    frameSlots = NULL;
+
+    allUsed(symtableFun); // perform semantic check of used variables
     if(returnType != void_){
         if(!allReturns(bodyAstRoot)){ // semantic check that all executable paths have return statement
                 ERROR(ERR_SEM_RETURN, "Function \"%s\" include path with no \"return\" statement.", funID);
@@ -285,7 +319,7 @@ bool def_func_sec(symNode *functionEntry, char *funID){
     }
     
     // build AST node
-    createDefFuncNode(funcAstNode, funID, symtableFun, bodyAstRoot, paramNames, paramNum, returnType, nullableRType); 
+    createDefFuncNode(funcAstNode, funID, symtableFun, bodyAstRoot, paramNames, paramNum, frameSize, returnType, nullableRType); 
     connectToBlock(funcAstNode, ASTree.root);
     GT
     return true;
@@ -319,7 +353,7 @@ bool def_func(bool firstTraverse){
 
 
     char *funID = currentToken.value;
-    symNode *functionEntry = findSymNode(funSymtable->rootPtr, funID);
+    symNode *functionEntry = findSymNode(funSymtable, funID);
     
     if(firstTraverse){
         def_func_first(functionEntry, funID);
@@ -364,7 +398,7 @@ bool params(int *paramNum, dataType **paramTypes, char ***paramNames, bool **par
         paramID = currentToken.value;
         symNode *entry = findInStack(&symtableStack, paramID);
         if(entry != NULL){ERROR(ERR_SEM_REDEF, "Redefining variable (%s) is not allowed.\n",paramID);}
-        entry = findSymNode(funSymtable->rootPtr, paramID);
+        entry = findSymNode(funSymtable, paramID);
         if(entry != NULL){ERROR(ERR_SEM_REDEF, "Shadowing function (%s) is not allowed.\n",paramID);}
         
         GT
@@ -386,9 +420,10 @@ bool params(int *paramNum, dataType **paramTypes, char ***paramNames, bool **par
 
         entryVarData.type       = paramType;
         entryVarData.isNullable = nullable;
+        entryVarData.slot       = *paramNum; // parameters occupy the first slots of the frame
         (*paramNum)++;
         entryData.data.vData    = entryVarData,
-        insertSymNode(symtableStack.top->tbPtr, paramID, entryData);
+        insertInStack(&symtableStack, paramID, entryData);
 
         params_n(paramNum, paramTypes, paramNames, paramNullable);
 
@@ -480,7 +515,7 @@ bool def_variable(astNode *block){
         varName = currentToken.value;
         symNode *varEntry = findInStack(&symtableStack, varName);
         if(varEntry != NULL){ERROR(ERR_SEM_REDEF, "Redefining variable (%s) is not allowed.\n",varName);}
-        varEntry = findSymNode(funSymtable->rootPtr, varName);
+        varEntry = findSymNode(funSymtable, varName);
         if(varEntry != NULL){ERROR(ERR_SEM_REDEF, "Shadowing function (%s) is not allowed.\n",varName);}
 
         GT
@@ -495,6 +530,7 @@ bool def_variable(astNode *block){
         entryData.used         = false;
         entryData.changed      = false;
         entryData.varOrFun     = 0;
+        variData.slot          = frameSlot(varName);
 
 
         if(currentToken.type != tokentype_assign){
@@ -563,9 +599,7 @@ bool def_variable(astNode *block){
         }
 
         entryData.data.vData = variData;
-        insertSymNode(symtableStack.top->tbPtr, varName, entryData);
-
-        varEntry = findInStack(&symtableStack, varName); // get the pointer to entry in symtable
+        varEntry = insertInStack(&symtableStack, varName, entryData); // get the pointer to entry in symtable
 
         createDefVarNode(varAstNode, varName, exprNode, varEntry); // create the correct representation
         connectToBlock(varAstNode, block); // connect it to create subtree (root will be the body of block)
@@ -920,8 +954,7 @@ bool exp_func_ret(dataType expRetType, bool nullableRetType, astNode **exprNode)
     // RULE 42 <exp_func_ret> -> ε
     if(currentToken.type == tokentype_semicolon){
         if(expRetType == void_){
-            free(*exprNode); // expression node will not be needed
-            *exprNode = NULL;
+            *exprNode = NULL; // expression node will not be needed
         }
         else{
             ERROR(ERR_SEM_RETURN, "Missing return value in non-void function.\n");
@@ -975,13 +1008,13 @@ bool id_without_null(bool *withNull, char **id_wout_null){
         // semantic checks for redefinition
         symNode *symEntry = findInStack(&symtableStack, currentToken.value);
         if(symEntry != NULL){ERROR(ERR_SEM_REDEF, "Redefining variable (%s) is not allowed.\n",*id_wout_null);}
-        symEntry = findSymNode(funSymtable->rootPtr, currentToken.value);
+        symEntry = findSymNode(funSymtable, currentToken.value);
         if(symEntry != NULL){ERROR(ERR_SEM_REDEF, "Shadowing function (%s) is not allowed.\n",*id_wout_null);}
 
         // add the ID_WITHOUT_NULL to symtable for if/while
-        varData variData = {.inheritedType = true, .isConst = true, .isNullable = false};
+        varData variData = {.inheritedType = true, .isConst = true, .isNullable = false, .slot = frameSlot(currentToken.value)};
         symData data = {.varOrFun = 0, .used = false, .data.vData = variData};
-        insertSymNode(symtableStack.top->tbPtr, currentToken.value, data);
+        insertInStack(&symtableStack, currentToken.value, data);
 
         GT
         
@@ -1031,6 +1064,7 @@ bool while_statement(dataType expRetType, bool nullableRType, astNode *block, bo
     // prepare info needed for correct construction of ast node while
     bool withNull;
     char *id_wout_null;
+    int   slotWoutNull = -1;
 
     // create new symtable for while and push it
     symtable *whileSymTable = createSymtable();
@@ -1061,7 +1095,9 @@ bool while_statement(dataType expRetType, bool nullableRType, astNode *block, bo
         }
     }
     else{
-        findInStack(&symtableStack, id_wout_null)->data.data.vData.type = condExprNode->nodeRep.exprNode.dataT;
+        symNode *woutNullEntry = findInStack(&symtableStack, id_wout_null);
+        woutNullEntry->data.data.vData.type = condExprNode->nodeRep.exprNode.dataT;
+        slotWoutNull = woutNullEntry->data.data.vData.slot;
         if(!checkIfNullable(condExprNode)){
             ERROR(ERR_SEM_TYPE, "Expression in while statement with null is not nullable.\n");
         }
@@ -1079,10 +1115,10 @@ bool while_statement(dataType expRetType, bool nullableRType, astNode *block, bo
     }
     GT
 
-    allUsed(symtableStack.top->tbPtr->rootPtr); // perform semantic check for used variables in block while
+    allUsed(symtableStack.top->tbPtr); // perform semantic check for used variables in block while
     // create node with correct info and connect it to block
     pop(&symtableStack); // pop, so scopes are not disturbed
-    createWhileNode(whileAstNode, withNull, id_wout_null, condExprNode, bodyAstNode, whileSymTable);
+    createWhileNode(whileAstNode, withNull, id_wout_null, slotWoutNull, condExprNode, bodyAstNode, whileSymTable);
     connectToBlock(whileAstNode, block);
 
     return true;
@@ -1121,6 +1157,7 @@ bool if_statement(dataType expRetType, bool nullableRType, astNode *block, bool
     // prepare information
     bool withNull;
     char *id_wout_null;
+    int   slotWoutNull = -1;
 
     // create new scope for if
     symtable *symtableForIf = createSymtable();
@@ -1147,7 +1184,9 @@ bool if_statement(dataType expRetType, bool nullableRType, astNode *block, bool
             }
             else{
                 // inherit datatype of id_wout_null from expression in condition 
-                findInStack(&symtableStack, id_wout_null)->data.data.vData.type = condExrpNode->nodeRep.exprNode.dataT; 
+                symNode *woutNullEntry = findInStack(&symtableStack, id_wout_null);
+                woutNullEntry->data.data.vData.type = condExrpNode->nodeRep.exprNode.dataT; 
+                slotWoutNull = woutNullEntry->data.data.vData.slot;
                 if(!checkIfNullable(condExrpNode)){
                     ERROR(ERR_SEM_TYPE, "Expression in if statement with null is not nullable.\n");
                 }
@@ -1159,7 +1198,7 @@ bool if_statement(dataType expRetType, bool nullableRType, astNode *block, bool
         if(currentToken.type == tokentype_rcbracket){
             GT
         if(currentToken.type == tokentype_kw_else){ 
-            allUsed(symtableStack.top->tbPtr->rootPtr); // perform semantic check for used variables in block if
+            allUsed(symtableStack.top->tbPtr); // perform semantic check for used variables in block if
             pop(&symtableStack); // pop the symtable for if so scopes are not disturbed
             push(&symtableStack, symtableForElse); // push the symtable for else 
             GT
@@ -1180,12 +1219,12 @@ bool if_statement(dataType expRetType, bool nullableRType, astNode *block, bool
         }
         }else{ERROR(ERR_SYNTAX, "Expected: \"(\" .\n");} 
     }else{ERROR(ERR_SYNTAX, "Expected: \"if\" .\n");}
-    allUsed(symtableStack.top->tbPtr->rootPtr); // perform semantic check for used variables in block else
+    allUsed(symtableStack.top->tbPtr); // perform semantic check for used variables in block else
     pop(&symtableStack); // pop the else stack so scopes are not disturbed
 
 
     // create nodes with correct information and connect it to block
-    createIfNode(ifNode, id_wout_null, symtableForIf, bodyIfNode);
+    createIfNode(ifNode, id_wout_null, slotWoutNull, symtableForIf, bodyIfNode);
     createElseNode(elseNode, symtableForElse, bodyElseNode);
     createIfElseNode(ifElseNode, condExrpNode, ifNode, elseNode, withNull);
 
@@ -1206,7 +1245,7 @@ bool expr_params(astNode **params, int *paramCnt){
     astNode *expr = createAstNode();
     // RULE 25 <expr_params> -> ε
     if(currentToken.type == tokentype_rbracket){
-        free(expr); // expression node not needed
+        // expression node not needed, it is released with compileArena
     }
     // RULE 24 <expr_params> -> expression <expr_params_n>
     else if(expression(expr)){ 
@@ -1340,7 +1379,7 @@ void assignmentHandle(char *id, astNode *block){
     // set data and build node
     entry->data.used    = true;
     entry->data.changed = true;
-    createAssignNode(newAssNode, id, newAssExpNode, varDataType);
+    createAssignNode(newAssNode, id, entry->data.data.vData.slot, newAssExpNode, varDataType);
     connectToBlock(newAssNode, block);
     
     return;
@@ -1372,10 +1411,10 @@ void assignmentHandle(char *id, astNode *block){
  * @note Function exits the whole program with suitable error message and code when encountering error. 
  */
 void funCallHandle(char *id, astNode *node, bool inExpr){
-        symNode *entry   = NULL;
-        bool builtinCall = false;
+        const symNode *entry = NULL;
+        bool builtinCall     = false;
         
-        astNode **exprParamsArr = malloc(sizeof(astNode*)*MAX_PARAM_NUM);
+        astNode  *exprParamsArr[MAX_PARAM_NUM]; // on stack, so nothing is lost when an error interrupts parsing
         int paramCnt            = 0;
         char *betterID = NULL;
         builtin(id, &entry, &builtinCall, &betterID);
@@ -1392,26 +1431,28 @@ void funCallHandle(char *id, astNode *node, bool inExpr){
         
 
         // already defined user function or builtin function was called, semantic check of the parameters and return type
-        if(entry->data.data.fData.returnType != void_ && !inExpr){
+        if(entry->data.data.fData->returnType != void_ && !inExpr){
             ERROR(ERR_SEM_FUN, "Non-void function \"%s\" called without storing the return value.\n", betterID);
         }
         
-        if(entry->data.data.fData.returnType == void_ && inExpr){
+        if(entry->data.data.fData->returnType == void_ && inExpr){
             ERROR(ERR_SEM_FUN, "Void function \"%s\" called in expression.\n", betterID);
         }
 
-        if(entry->data.data.fData.paramNum != paramCnt){
+        if(entry->data.data.fData->paramNum != paramCnt){
             ERROR(ERR_SEM_FUN, "Calling \"%s\" with wrong number of parameters.\nExpected: %d\nGot: %d\n", 
-                                betterID, entry->data.data.fData.paramNum, paramCnt);
+                                betterID, entry->data.data.fData->paramNum, paramCnt);
         }
         int badIndex = 0; // index on which wrong parameter is
-        if(!checkParameterTypes(entry->data.data.fData.paramTypes, exprParamsArr, paramCnt, &badIndex)){
+        if(!checkParameterTypes(entry->data.data.fData->paramTypes, exprParamsArr, paramCnt, &badIndex)){
             ERROR(ERR_SEM_FUN, "Parameter number %d in \"%s\" function call has wrong type.\n", badIndex, betterID);
         }
-        if(!checkParameterNullability(entry->data.data.fData.paramNullable, exprParamsArr, paramCnt, &badIndex)){
+        if(!checkParameterNullability(entry->data.data.fData->paramNullable, exprParamsArr, paramCnt, &badIndex)){
             ERROR(ERR_SEM_FUN, "Parameter number %d in \"%s\" function call cannot be nullable.\n", badIndex, betterID);
         }
-        createFuncCallNode(node, betterID, entry->data.data.fData.returnType, builtinCall, entry, exprParamsArr, paramCnt, entry->data.data.fData.nullableRType);
+        astNode **paramExpr = arenaAlloc(&compileArena, sizeof(astNode *) * paramCnt); // keep only used part of the array
+        memcpy(paramExpr, exprParamsArr, sizeof(astNode *) * paramCnt);
+        createFuncCallNode(node, betterID, entry->data.data.fData->returnType, builtinCall, entry, paramExpr, paramCnt, entry->data.data.fData->nullableRType);
 }
 
 /**
@@ -1444,7 +1485,7 @@ bool assign_or_f_call(astNode *block){
  * 
  * @return True if processing successful.
  */
-bool builtin(char *id, symNode **symtableNode, bool *builtinCall, char **betterID){
+bool builtin(char *id, const symNode **symtableNode, bool *builtinCall, char **betterID){
     // RULE 31 <builtin> -> . id
     if(currentToken.type == tokentype_dot){
         
@@ -1462,7 +1503,11 @@ bool builtin(char *id, symNode **symtableNode, bool *builtinCall, char **betterI
     }
     // RULE 32 <builtin> -> ε
     else if(currentToken.type == tokentype_lbracket){
-        *symtableNode = findSymNode(funSymtable->rootPtr, id);
+        symNode *userFun = findSymNode(funSymtable, id);
+        if(userFun != NULL){
+            userFun->data.used = true; // set for semantic check, entries of builtins are shared and read-only
+        }
+        *symtableNode = userFun;
         *builtinCall = false;
         *betterID = id;
     }else{ERROR(ERR_SYNTAX, "Expected: \"(\" or \".\".\n");}
@@ -1486,13 +1531,13 @@ bool builtin(char *id, symNode **symtableNode, bool *builtinCall, char **betterI
  * @return True if all correct, false if an error occurs.
  */
 bool mainDefined(){
-    symNode *found = findSymNode(funSymtable->rootPtr, "main");
+    symNode *found = findSymNode(funSymtable, "main");
     if(found == NULL){
         ERROR(ERR_SEM_UNDEF, "Definition for function \"main\" was not found.\n");
         return false;
     }
 
-    funData data = found->data.data.fData;
+    funData data = *found->data.data.fData;
 
     if(data.returnType != void_){
         ERROR(ERR_SEM_FUN, "Function \"main\" must have return type \"void\".\n");
@@ -1511,7 +1556,7 @@ bool mainDefined(){
  * @brief      Validates that all entries that were defined are also used in scope and checks if all called
  *             functions were defined.
  * 
- *             Function uses resursive preorder traversal to go through the BST.
+ *             Function goes through all entries of the symtable.
  *             When an entry of a *variable* or *function* which "used" flag is false is found, function
  *             triggers error.
  *             When an entry of a *variable* that is not constant which "changed" flag is false is found,
@@ -1521,14 +1566,16 @@ bool mainDefined(){
  * 
  * @see        symData
  * 
- * @param root Root of a (sub)tree to traverse through.
+ * @param tb   Symtable to go through.
  * 
  */
-void allUsed(symNode *root){
+void allUsed(symtable *tb){
 
-    if(root != NULL){
+    int      pos  = 0;
+    symNode *root = NULL;
+    while((root = nextSymNode(tb, &pos)) != NULL){
 
-        if(root->data.varOrFun == 1 && !root->data.data.fData.defined){
+        if(root->data.varOrFun == 1 && !root->data.data.fData->defined){
             ERROR(ERR_SEM_UNDEF, "Function \"%s\" called but never defined.\n", root->key);
         }
 
@@ -1544,8 +1591,6 @@ void allUsed(symNode *root){
         if(root->data.varOrFun == 0 && !root->data.data.vData.isConst && !root->data.changed){
             ERROR(ERR_SEM_UNUSED, "Modifiable variable \"%s\" has no chance of changing after initialization within block.\n", root->key);
         }
-        allUsed(root->l);
-        allUsed(root->r);
     }
 
 }
@@ -1584,9 +1629,9 @@ bool wasDefined(char *ID, symNode **node){
  * @return   dataType
  */
 dataType getReturnType(char *ID){
-    symNode *entry = findSymNode(funSymtable->rootPtr, ID);
+    symNode *entry = findSymNode(funSymtable, ID);
 
-    return entry->data.data.fData.returnType;
+    return entry->data.data.fData->returnType;
 }
 
 /**
@@ -1664,20 +1709,42 @@ bool checkParameterNullability(bool *expected, astNode **given, int paramNum, in
     return true;
 }
 
+/**
+ * @brief      Returns frame slot of a variable in the currently processed function.
+ * 
+ *             Slots are dense and numbered from 0 in order of first definition. Variables
+ *             with the same name in different (sibling) scopes share the slot, as they
+ *             live in the same frame.
+ * 
+ * @param name Name of the variable.
+ * 
+ * @return     Slot of the variable.
+ */
+int frameSlot(char *name){
+    symNode *entry = findSymNode(frameSlots, name);
+    if(entry != NULL){
+        return entry->data.data.vData.slot;
+    }
+
+    symData data = {.varOrFun = 0, .data.vData.slot = frameSlots->nodeCnt};
+    insertSymNode(frameSlots, name, data);
+    return data.data.vData.slot;
+}
+
 /**
  * @brief Validates that given builtin function id is valid.
  * 
- *        Function searches builtinSymtable for an entry with key given
+ *        Function searches static table of builtins for an entry with key given
  *        by id. If it is not found, semantic error is triggered.
  *        
- * @see findSymNode()
+ * @see findBuiltin()
  * 
  * @param id Id of the builtin function to find.
  * 
- * @return Entry of the builtin function in builtinSymtable if valid.
+ * @return Entry of the builtin function in table of builtins if valid.
  */
-symNode *checkBuiltinId(char *id){
-    symNode *symtableNode = findSymNode(builtinSymtable->rootPtr, id);
+const symNode *checkBuiltinId(char *id){
+    const symNode *symtableNode = findBuiltin(id);
     if(symtableNode == NULL){
         ERROR(ERR_SEM_UNDEF, "Builtin function with id \"%s\" does not exist.\n", id);
     }
@@ -1849,10 +1916,12 @@ bool allReturns(astNode *statement){
 astNode *parser(){
 
     initStack(&symtableStack);
-    prepareBuiltinSymtable();
     funSymtable = createSymtable();
 
     prog(true); // first pass, just collect information about defined functions
+    if(incremental != NULL){
+        incrPlan(incremental);
+    }
     reset_scanner();
     prog(false); // second pass, do everything else
 
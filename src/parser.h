@@ -16,8 +16,10 @@
 #include "scanner.h"
 #include "symtable.h"
 #include "ast.h"
+#include "arena.h"
 #include "error.h"
 #include "expression_parser.h"
+#include "incremental.h"
 
 //#define DEBUG
 #ifdef DEBUG
@@ -30,8 +32,9 @@
 
 #define GT currentToken = getToken(); // encapsulating the assignment
 
-extern Token currentToken; // last token produced by scanner
-extern AST   ASTree;       // AST for the whole program
+extern THREAD_LOCAL Token currentToken; // last token produced by scanner
+extern THREAD_LOCAL AST   ASTree;       // AST for the whole program
+extern THREAD_LOCAL symtable *frameSlots; // frame slots of variables in the currently processed function
 
 
 astNode *parser();
@@ -66,7 +69,7 @@ bool expr_params(astNode **params, int *paramCnt);
 bool expr_params_n(astNode **params, int *paramCnt);
 bool after_id(char *id, astNode *block);
 bool assign_or_f_call(astNode *block);
-bool builtin(char *id, symNode **symtableNode, bool *builtinCall, char **betterID);
+bool builtin(char *id, const symNode **symtableNode, bool *builtinCall, char **betterID);
 
 void funCallHandle(char *id, astNode *node, bool inExpr);
 void assignmentHandle(char *id, astNode *block);
@@ -74,13 +77,14 @@ void assignmentHandle(char *id, astNode *block);
 /* HELPER FUNCTIONS */
 
 bool     mainDefined();
-void     allUsed(symNode *root);
+void     allUsed(symtable *tb);
 bool     wasDefined(char *ID, symNode **node);
 dataType getReturnType(char *ID);
 dataType getVarType(char *ID);
 bool     checkParameterTypes(dataType *expected, astNode **given, int paramNum, int *badIndex);
 bool     checkParameterNullability(bool *expected, astNode **given, int paramNum, int *badIndex);
-symNode *checkBuiltinId(char *id);
+const symNode *checkBuiltinId(char *id);
+int      frameSlot(char *name);
 bool     checkIfNullable(astNode *expr);
 bool     checkIfExprLogic(astNode *expr);
 void     extractValueToConst(dataType exprType, astNode *exprTree, varData *variData);
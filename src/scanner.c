@@ -5,7 +5,7 @@
  * 
  * @brief  Implementation of scanner for IFJ24
  * 
- *         Scanner reads from standard input and processes
+ *         Scanner reads from standard input (or a stream set by set_input) and processes
  *         input into tokens. Tokens hold information about
  *         their value, their line and their type. It also
  *         recognizes lexical errors and calls an error function
@@ -16,6 +16,7 @@
 */
 
 #include "scanner.h"
+#include "arena.h"
 
 // This array of strings holds each keyword in order to be recognized as keywords
 const char *keywords[NUM_OF_KEYWORDS] = {
@@ -23,9 +24,21 @@ const char *keywords[NUM_OF_KEYWORDS] = {
     "pub", "return", "u8", "var", "void", "while"
 };
 
-int Line_Number = 1;            //Initializing Line_Number to 1, because we are starting on the first line
-int Column_Number = 0;          //Initializing Column_Numer to 0, because we havent yet read any character
-TokenValues *head = NULL;       //Initializing the head of linked list holding values of tokens to NULL
+THREAD_LOCAL int Line_Number = 1;          //Initializing Line_Number to 1, because we are starting on the first line
+THREAD_LOCAL int Column_Number = 0;        //Initializing Column_Numer to 0, because we havent yet read any character
+THREAD_LOCAL FILE *Input_File = NULL;      //Stream the scanner reads from, standard input is used when NULL
+THREAD_LOCAL uint64_t *Token_Hash = NULL;  //Hash updated by every read token, see hash_tokens
+
+#define INPUT (Input_File != NULL ? Input_File : stdin)
+
+/**
+ * @brief Function which sets the stream the scanner reads from.
+ * 
+ * @param input Stream to read from, it has to support rewind. NULL selects standard input.
+ */
+void set_input(FILE *input) {
+    Input_File = input;
+}
 
 
 /**
@@ -40,14 +53,14 @@ TokenValues *head = NULL;       //Initializing the head of linked list holding v
  * 
  */
 token_types is_next_token(Token *token, char expected_char, token_types type1,token_types type2){
-    char nextchar = getc(stdin);
+    char nextchar = getc(INPUT);
     if(nextchar == expected_char) {
         Column_Number++;
         token->type = type2;
         return type2;
     }
     else {
-        ungetc(nextchar, stdin);
+        ungetc(nextchar, INPUT);
         token->type = type1;
         return type1;
     }
@@ -106,41 +119,34 @@ int realloc_value(char **buffer, int *buffer_size) {
 }
 
 /**
- * @brief Function which adds the value of token into a linked list in order to be freed later.
+ * @brief Function which moves the finished value of token into compileArena in order to be freed later.
  * 
- * @param value Holds the pointer to a memory containing value of token.
+ * @param value Holds the pointer to a memory containing value of token, it is freed.
  * 
+ * @return Pointer to the copy of the value in compileArena.
  */
-void add_value_pointer(char *value) {
-    TokenValues *new_node = (TokenValues *) malloc(sizeof(TokenValues));
-    if(new_node == NULL) {
-        ERRORLEX(ERR_INTERNAL, "Failed to allocate memory for TokenValues.\n");
-    }
-    new_node->value = value;
-    new_node->next = head;
-    head = new_node;
-
+char *store_value(char *value) {
+    size_t len    = strlen(value) + 1;
+    char  *stored = arenaAlloc(&compileArena, len);
+    memcpy(stored, value, len);
+    free(value);
+    return stored;
 }
 
 /**
  * @brief Function which frees all allocated memory for holding the value of tokens.
+ *
+ *        Values are stored in compileArena, so the whole arena is released.
  */
 void free_all_values() {
-    TokenValues *current = head;
-    while(current != NULL) {
-        TokenValues *temp = current;
-        free(current->value);
-        current = current->next;
-        free(temp);
-    }
-    head = NULL;
+    arenaRelease(&compileArena);
 }
 
 /**
  * @brief Function which resets the scanner to initial state, ready to read from input again.
  */
 void reset_scanner() {
-    rewind(stdin);
+    rewind(INPUT);
     Line_Number = 1;
     Column_Number = 0;
 }
@@ -148,11 +154,11 @@ void reset_scanner() {
 /**
  * @brief   Main scanner function which tokenizes the input.
  * 
- * @return  getToken functions returns a single token which contains its value,
+ * @return  read_token functions returns a single token which contains its value,
  *          its type its line and column number
  * 
  */
-Token getToken() {
+static Token read_token() {
     
     char c;                              // first character which will be read from input
     char nextchar;                       // next character which will be read from input
@@ -163,7 +169,7 @@ Token getToken() {
     int FirstCharOfToken;                // declaring an integer for storing the index of first char of token
     
     here:
-    while((c = getc(stdin)) == ' ' || c == '\t' || c == '\n') { //Skipping every white character
+    while((c = getc(INPUT)) == ' ' || c == '\t' || c == '\n') { //Skipping every white character
         Column_Number++;
         if(c == '\n') {             
             Line_Number++; 
@@ -182,15 +188,16 @@ Token getToken() {
     }
     switch(c) {       //switch for making decisions based on the first character read
         case '/':
-            if((c = getc(stdin)) == '/') {
+            if((c = getc(INPUT)) == '/') {
                 Column_Number++;
                 while(c != '\n') {
                     if(c == EOF) {
                         current_token.type = tokentype_EOF;
                         current_token.line = Line_Number;
+                        current_token.column = Column_Number;
                         return current_token;
                     }
-                    c = getc(stdin);
+                    c = getc(INPUT);
                     continue;
                 }
                 Line_Number++;
@@ -198,7 +205,7 @@ Token getToken() {
                 goto here;                      //Jump to the beginning of getToken to start reading again.
             }       
             else {
-                ungetc(c, stdin);
+                ungetc(c, INPUT);
                 current_token.type = tokentype_divide; 
                 break;
             }
@@ -271,13 +278,13 @@ Token getToken() {
             break;
 
         case '!':
-            nextchar = getc(stdin);
+            nextchar = getc(INPUT);
             if (nextchar == '=') {
                 Column_Number++;
                 current_token.type = tokentype_notequal;
             }
             else {
-                ungetc(nextchar, stdin);
+                ungetc(nextchar, INPUT);
                 ERRORLEX(ERR_LEX, "Invalid character on line %d, column %d.\n", Line_Number, Column_Number);
             }
             break;
@@ -308,13 +315,13 @@ Token getToken() {
             }
 
             else if (c == '_') {
-                nextchar = getc(stdin);
+                nextchar = getc(INPUT);
                 if(!isalnum(nextchar) && nextchar != '_') {
                     current_token.type = tokentype_pseudovar;
-                    ungetc(nextchar, stdin);
+                    ungetc(nextchar, INPUT);
                 }
                 else {
-                    ungetc(nextchar, stdin);
+                    ungetc(nextchar, INPUT);
                     current_token = process_ID_Token(c);
                 }
             }
@@ -323,7 +330,7 @@ Token getToken() {
             }    
     }
     if(current_token.value != NULL) {
-        add_value_pointer(current_token.value); //Adding value to list of values.
+        current_token.value = store_value(current_token.value); //Moving value to compileArena.
     }
 
     current_token.line = Line_Number;
@@ -351,8 +358,8 @@ Token process_Number_Token(char firstchar) {
 
     //processing zero and whole part of a number
     if(firstchar == '0') {
-        if(isdigit(nextchar = getc(stdin))) {
-            ungetc(nextchar, stdin);
+        if(isdigit(nextchar = getc(INPUT))) {
+            ungetc(nextchar, INPUT);
             ERRORLEX(ERR_LEX, "A whole number cannot start with 0. Line %d, column %d.\n", Line_Number, Column_Number);
         }
         else {
@@ -362,7 +369,7 @@ Token process_Number_Token(char firstchar) {
     else {
         current_token.type = tokentype_int;
         
-        while(isdigit((nextchar = getc(stdin)))) {
+        while(isdigit((nextchar = getc(INPUT)))) {
             if (index >= buffer_size - 1) {              
                 realloc_value(&current_token.value, &buffer_size);
             }
@@ -376,7 +383,7 @@ Token process_Number_Token(char firstchar) {
         current_token.type = tokentype_float;
         current_token.value[index++] = (char) nextchar;
             
-        while(isdigit((nextchar = getc(stdin)))) { 
+        while(isdigit((nextchar = getc(INPUT)))) { 
             if (index >= buffer_size - 1) {
                 realloc_value(&current_token.value, &buffer_size);
             }
@@ -390,11 +397,11 @@ Token process_Number_Token(char firstchar) {
         current_token.type = tokentype_exponentialnum;
         current_token.value[index++] = (char) nextchar; 
 
-        nextchar = getc(stdin);
+        nextchar = getc(INPUT);
         Column_Number++;
         if(nextchar == '+' || nextchar == '-') {    
             current_token.value[index++] = (char) nextchar;
-            nextchar = getc(stdin);
+            nextchar = getc(INPUT);
             Column_Number++;
         }
 
@@ -403,7 +410,7 @@ Token process_Number_Token(char firstchar) {
                 realloc_value(&current_token.value, &buffer_size);
             }
             current_token.value[index++] = (char) nextchar;
-            nextchar = getc(stdin);
+            nextchar = getc(INPUT);
             Column_Number++;
         }
     }
@@ -416,7 +423,7 @@ Token process_Number_Token(char firstchar) {
         ERRORLEX(ERR_LEX, "Number incomplete on line %d, column %d.\n", Line_Number, Column_Number);
     }       
     
-    ungetc(nextchar, stdin);
+    ungetc(nextchar, INPUT);
 
     current_token.value[index] = '\0'; 
        
@@ -439,7 +446,7 @@ Token process_String_Token() {
 
     init_value(&current_token.value, buffer_size); 
  
-    while((nextchar = getc(stdin)) != '"' && nextchar != '\n') { 
+    while((nextchar = getc(INPUT)) != '"' && nextchar != '\n') { 
         
         Column_Number++;
 
@@ -453,7 +460,7 @@ Token process_String_Token() {
         //if statement for handling all escape sequences and hexadecimal numbers in string.
         if(nextchar == 92) {    
             
-            nextchar = getc(stdin);
+            nextchar = getc(INPUT);
             Column_Number++;
             
             //correctly assigning each escape sequence directly into string value
@@ -478,7 +485,7 @@ Token process_String_Token() {
                 char hex_str[3] = {0};  
                 
                 for(int i = 0; i < 2; i++) {   
-                    if(((nextchar = getc(stdin)) >= '0' && nextchar <= '9') ||
+                    if(((nextchar = getc(INPUT)) >= '0' && nextchar <= '9') ||
                         (nextchar >= 'a' && nextchar <= 'f') || 
                         (nextchar >= 'A' && nextchar <= 'F'))    
                     {
@@ -544,7 +551,7 @@ Token process_ID_Token(char firstchar) {
     current_token.value[index++] = firstchar; 
 
     //reading until we find a character not allowed in ID
-    while((isalpha(nextchar = getc(stdin))) || isdigit(nextchar) || nextchar == '_') {
+    while((isalpha(nextchar = getc(INPUT))) || isdigit(nextchar) || nextchar == '_') {
         if (index >= buffer_size - 1) {
             realloc_value(&current_token.value, &buffer_size);
         }
@@ -553,7 +560,7 @@ Token process_ID_Token(char firstchar) {
     }
     current_token.value[index] = '\0';
 
-    ungetc(nextchar, stdin);         
+    ungetc(nextchar, INPUT);         
 
     is_keyword(current_token.value, &current_token);    //decide whether the ID is a keyword or not
 
@@ -576,7 +583,7 @@ Token process_Import() {
     int i = 0;
 
     while (keyword[i] != '\0') {
-        nextchar = getc(stdin);
+        nextchar = getc(INPUT);
         Column_Number++;
         if (nextchar != keyword[i]) {
             ERRORLEX(ERR_LEX, "Import incorrect on line %d, column %d.\n", Line_Number, Column_Number);  
@@ -600,7 +607,7 @@ Token process_Multiline_String_Token() {
 
     init_value(&current_token.value, buffer_size);
     
-    if((nextchar = getc(stdin)) == '\\') {      
+    if((nextchar = getc(INPUT)) == '\\') {      
         current_token.type = tokentype_string;
 
         while(1) {
@@ -608,27 +615,27 @@ Token process_Multiline_String_Token() {
             if (index >= buffer_size - 1) {
                 realloc_value(&current_token.value, &buffer_size); 
             }
-            nextchar = getc(stdin);
+            nextchar = getc(INPUT);
             if(nextchar == EOF) {   
                 break;
             }
             if(nextchar == '\n') {  //Checking if the multiline continues on the next line
                 Line_Number++;
                 char tempchar;
-                while((tempchar = getc(stdin)) != EOF && isspace(tempchar)) { 
+                while((tempchar = getc(INPUT)) != EOF && isspace(tempchar)) { 
                     if(tempchar == '\n') { 
                         break;
                     }
                 }
                 
-                if(tempchar == '\\' && (nextchar = getc(stdin)) == '\\') {
+                if(tempchar == '\\' && (nextchar = getc(INPUT)) == '\\') {
                     current_token.value[index++] = '\n';   
                     continue;
                 }
                 else {
                     Line_Number--;             
-                    ungetc(tempchar, stdin);  
-                    ungetc(nextchar, stdin);
+                    ungetc(tempchar, INPUT);  
+                    ungetc(nextchar, INPUT);
                     break;
                 }
             }
@@ -645,4 +652,32 @@ Token process_Multiline_String_Token() {
     return current_token;
 }
 
+/**
+ * @brief Function which makes the scanner add every read token to a hash.
+ * 
+ * @param hash Hash to update (FNV-1a over types and values of tokens), NULL stops hashing.
+ */
+void hash_tokens(uint64_t *hash) {
+    Token_Hash = hash;
+}
+
+/**
+ * @brief   Function which returns the next token of the input.
+ * 
+ * @return  Next token, see read_token.
+ */
+Token getToken() {
+    Token token = read_token();
+
+    if(Token_Hash != NULL) {
+        uint64_t h = *Token_Hash;
+        h = (h ^ (uint64_t)token.type) * 0x100000001B3ULL;
+        for(char *c = token.value; c != NULL && *c != '\0'; c++) {
+            h = (h ^ (unsigned char)*c) * 0x100000001B3ULL;
+        }
+        *Token_Hash = (h ^ 0xFF) * 0x100000001B3ULL; // end of value, so values can not be shifted into each other
+    }
+    return token;
+}
+
 /* END OF FILE scanner.c */
\ No newline at end of file
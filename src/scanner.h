@@ -19,14 +19,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <string.h>
 #include "error.h"
 
 #define NUM_OF_KEYWORDS 13 //Defining the number of keywords.
 
-extern int Line_Number;    //Global variable for tracking the line number.
-extern int Column_Number;  //Global variable for tracking the column number.
+extern THREAD_LOCAL int Line_Number;    //Global variable for tracking the line number.
+extern THREAD_LOCAL int Column_Number;  //Global variable for tracking the column number.
 
 /*
 An enum holding each of the types of token possible.
@@ -100,15 +101,6 @@ typedef struct {
     char* value;
 } Token;
 
-/*
-Linked list for storing values of each token,
-containing the value of token and a pointer to the value
-*/
-typedef struct TokenValues {
-    char *value;
-    struct TokenValues *next;
-} TokenValues;
-
 //FUNCTION DECLARATIONS
 extern const char *keywords[NUM_OF_KEYWORDS];
 
@@ -132,12 +124,16 @@ int init_value(char **buffer, int initial_size);
 
 int realloc_value(char **buffer, int *buffer_size);
 
-void add_value_pointer(char *value);
+char *store_value(char *value);
 
 void free_all_values();
 
 void reset_scanner();
 
+void set_input(FILE *input);
+
+void hash_tokens(uint64_t *hash);
+
 #endif
 
 /* END OF FILE scanner.h */
\ No newline at end of file
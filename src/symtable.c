@@ -3,14 +3,19 @@
  * 
  * @file   symtable.c
  * 
- * @brief  AVL-balanced binary search (vv-BVS) tree implementation of a table of symbols for a compiler.
+ * @brief  Hash table implementation of a table of symbols for a compiler.
  * 
  *         File contains implementation for functions declared in symtable.h. Table of symbols (symtable) is
- *         implemented as a height-balanced binary search tree. Most of the functions are implemented recursively.
- *         The tree balances when inserting or deleting a node, when necessary using rotations.
+ *         implemented as a hash table with open addressing and linear probing, using Robin Hood hashing:
+ *         when inserting, an entry that is closer to its home slot gives its place to an entry that is
+ *         further from its own home slot. This keeps probe sequences short and lets search stop early.
+ *         Deletion uses backward shifting, so no tombstones are needed.
+ *         Each slot caches the hash of its key, so strings are compared only when the hashes match.
+ *         Nodes are allocated separately and never move, so pointers to symNode stay valid after the
+ *         table grows. Nodes and function data are taken from pools (slabs of fixed-size blocks), node
+ *         holds only data needed for variables, function data are allocated separately (hot/cold split),
+ *         so a node fits into one cache line.
  *         Symtables can be stored in a stack, so that representation of scopes in code is possible.
- *         
- *         Implementation is mainly based on practices taught in IAL course at FIT VUT. 
  * 
  * @author xnovakf00 Filip Novák
  * @date   21.11.2024
@@ -18,10 +23,20 @@
 
 #include "symtable.h"
 #include "parser.h"
+#include "arena.h"
 
-stack symtableStack;
-symtable *funSymtable;
-symtable *builtinSymtable;
+#define SYMTABLE_INIT_CAPACITY 8  // must be power of 2
+#define SYMPOOL_SLAB_BLOCKS    64 // number of blocks allocated at once by a pool
+#define CACHE_LINE             64
+
+// Compile-time check, array size is negative (compile error) if a symNode does not fit into a pool block
+typedef char symNodeFitsCacheLine[sizeof(symNode) <= CACHE_LINE ? 1 : -1];
+
+THREAD_LOCAL stack symtableStack;
+THREAD_LOCAL symtable *funSymtable;
+
+THREAD_LOCAL symPool nodePool = {.blockSize = CACHE_LINE, .freeList = NULL, .slabs = NULL}; // one symNode per cache line
+THREAD_LOCAL symPool funPool  = {.blockSize = sizeof(funData), .freeList = NULL, .slabs = NULL};
 
 /**
  * @brief  Creates an empty symtable.
@@ -29,11 +44,7 @@ symtable *builtinSymtable;
  * @return Initialised table if allocation is successful, NULL otherwise.
  */
 symtable* createSymtable(){
-    symtable *table = (symtable *)malloc(sizeof(symtable));
-    if(table == NULL){
-        ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
-        return NULL;
-    }
+    symtable *table = (symtable *)arenaAlloc(&compileArena, sizeof(symtable));
     initSymtable(table);
     return table;
 }
@@ -41,35 +52,34 @@ symtable* createSymtable(){
 /**
  * @brief          Initialises symtable for further work.
  * 
+ *                 Slots are not allocated until the first symbol is inserted.
+ * 
  * @param symtable Symtable to be initialised.
  */
 
 void initSymtable(symtable *tb){
-    tb->nodeCnt = 0;
-    tb->rootPtr = NULL;
+    tb->nodeCnt  = 0;
+    tb->capacity = 0;
+    tb->slots    = NULL;
 }
 
 /**
  * @brief      Creates an element of a symtable, symNode with key and data.
  * 
- * @param key  Key on which the node will be located in the tree.
+ * @param key  Key under which the node will be stored in the table.
+ * @param hash Hash of the key.
  * @param data Extra useful data describing the symbol element.
  * 
  * 
  * @return     Pointer to the created symNode.
  */
-symNode *createSymNode(char *key, symData data){
-    symNode *newNode = (symNode *)malloc(sizeof(symNode));
-    if(newNode == NULL){
-        ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
-        return NULL;
-    }
+symNode *createSymNode(char *key, unsigned hash, symData data){
+    symNode *newNode = (symNode *)poolAlloc(&nodePool);
 
-    newNode->data   = data;
-    newNode->key    = key;
-    newNode->height = 1;
-    newNode->l      = NULL;
-    newNode->r      = NULL;
+    newNode->data     = data;
+    newNode->key      = key;
+    newNode->hash     = hash;
+    newNode->shadowed = NULL;
 
     return newNode;
 }
@@ -77,187 +87,155 @@ symNode *createSymNode(char *key, symData data){
 /**
  * @brief      Insert new symbol into table of symbols.
  * 
- *             This function is a wrapper of insertSymNodeRec function.
+ *             When there is no node in the symtable with the same key as the inserted node, it is
+ *             created and added. If the table includes a node with the same key, the data is rewritten.
+ *             The table grows when it would be more than 3/4 full.
  * 
  * @param tb   Pointer to a symtable.
  * @param key  String key of a symbol to add.
  * @param data Data for the new symbol to hold.
  * 
- * @see        insertSymNodeRec
+ * @see        placeSymNode
  * 
+ * @return     Pointer to the inserted (or rewritten) symNode.
  */
-void insertSymNode(symtable *tb, char *key, symData data){
-    tb->rootPtr = insertSymNodeRec(tb->rootPtr, key, data, tb);
-}
-
-/**
- * @brief         Inserts a new node into a symtable.
- * 
- *                When there is no node in the symtable with the same key as the inserted node, it is
- *                created and added. If the tree includes a node with the same key, the data is rewritten.
- *                After inserting, rotations are performed, if necessary to keep the tree balanced.
- *                It is implemented recursively.
- *                The pointer to the root node is necessary for recursion, that is why there is not just the 
- *                pointer to the whole tree.
- * 
- * @param rootPtr Pointer to the root of the tree (subtree if in recursion).
- * @param key     Key of the node to be inserted.
- * @param data    Data for the node.
- * @param tb      Pointer to a symtable for increasing the count.
- * 
- * @return        The root of the updated tree (subtree) after insertion.
- * 
- */
-symNode *insertSymNodeRec(symNode *rootPtr, char *key, symData data, symtable *tb){
-    if(rootPtr == NULL){
-        tb->nodeCnt++;
-        return createSymNode(key, data);
-    }
-    else{
-        if(strcmp(key, rootPtr->key) < 0){ // going left
-            rootPtr->l = insertSymNodeRec(rootPtr->l, key, data, tb);
-        }
-        else if(strcmp(key, rootPtr->key) > 0){ // going right
-            rootPtr->r = insertSymNodeRec(rootPtr->r, key, data, tb);
-        }
-        else{ // keys are identical, data rewrite
-            rootPtr->data = data;
+symNode *insertSymNode(symtable *tb, char *key, symData data){
+    unsigned hash = hashKey(key);
+    int      slot = findSlot(tb, key, hash);
+
+    if(slot >= 0){ // keys are identical, data rewrite
+        symNode *node = tb->slots[slot].node;
+        if(node->data.varOrFun && !(data.varOrFun && data.data.fData == node->data.data.fData)){
+            freeFunData(node->data.data.fData);
         }
+        node->data = data;
+        return node;
     }
 
-    rootPtr->height = max(heightVal(rootPtr->l),heightVal(rootPtr->r)) + 1;
+    if((tb->nodeCnt + 1) * 4 > tb->capacity * 3){
+        growSymtable(tb);
+    }
 
-    return rebalance(rootPtr);
+    symNode *newNode = createSymNode(key, hash, data);
+    placeSymNode(tb, newNode);
+    tb->nodeCnt++;
+    return newNode;
 }
 
 /**
  * @brief      Delete symbol from table of symbols.
  * 
- *             This function is a wrapper of deleteSymNodeRec function.
+ *             If a node with the specified key exists, it is removed from the table. 
+ *             Entries following it in the same probe sequence are shifted one slot
+ *             back, so the table stays valid without tombstones.
  * 
  * @param tb   Pointer to a symtable.
  * @param key  String key of a symbol to delete.
- * 
- * @see        deleteSymNodeRec
  */
 void deleteSymNode(symtable *tb, char *key){
-    tb->rootPtr = deleteSymNodeRec(tb->rootPtr, key, tb);
+    int slot = findSlot(tb, key, hashKey(key));
+    if(slot < 0){
+        return;
+    }
+
+    freeSymNode(tb->slots[slot].node);
+    removeSlot(tb, slot);
 }
 
 /**
- * @brief         Deletes a node from the symtable (AVL tree).
- * 
- *                If a node with the specified key exists, it is removed from the tree 
- *                and the tree is reconstructed, if the deleted node had children. 
- *                After deletion, rotations are performed if necessary.
+ * @brief     Finds a node in the symtable based on the key.
  * 
- *                Similar to insertion, the function is implemented recursively, requiring the pointer 
- *                to the root node to traverse the tree. 
+ * @param tb  Pointer to the symtable for the node to be found.
+ * @param key Key of the node to be found.
  * 
- * @param rootPtr Pointer to the root of the tree (or subtree).
- * @param key     Key of the node to be deleted.
- * @param tb      Pointer to a symtable for decreasing the count.
- * 
- * @return        The new root of the balanced tree after deletion.
+ * @return    If the node is found, the pointer to it. If the node does not exist, NULL.
  */
-symNode *deleteSymNodeRec(symNode *rootPtr, char *key, symtable *tb){
-    if(rootPtr == NULL){
+symNode *findSymNode(symtable *tb, char *key){
+    int slot = findSlot(tb, key, hashKey(key));
+    if(slot < 0){
         return NULL;
     }
-
-    if(strcmp(key, rootPtr->key) < 0){ // going left
-        rootPtr->l = deleteSymNodeRec(rootPtr->l, key, tb);
-        return rootPtr;
-    }
-    else if(strcmp(key, rootPtr->key) > 0){ // going right
-        rootPtr->r = deleteSymNodeRec(rootPtr->r, key, tb);
-    }
-    else{ // found
-        if(rootPtr->r == NULL && rootPtr->l == NULL){ // no children
-            free(rootPtr);
-            tb->nodeCnt--;
-            return NULL;
-        }
-        else if(rootPtr->r != NULL && rootPtr->l != NULL){ // both children
-            symNode *min  = minSymNode(rootPtr->r);
-            rootPtr->key  = min->key;
-            rootPtr->data = min->data;
-            rootPtr->r    = deleteSymNodeRec(rootPtr->r, min->key, tb);
-            return rootPtr;
-        }
-        else{ // only one child
-            symNode *tmp = NULL;
-            if(rootPtr->l == NULL){
-                tmp = rootPtr->r;
-            }
-            else{
-                tmp = rootPtr->l;
-            }
-            free(rootPtr);
-            tb->nodeCnt--;
-            return tmp;
-        }
-    }
-
-    rootPtr->height = max(heightVal(rootPtr->l),heightVal(rootPtr->r)) + 1;
-
-    return rebalance(rootPtr);
+    return tb->slots[slot].node;
 }
 
 /**
- * @brief         Recursively finds a node in the symtable based on the key.
+ * @brief     Iterates through all nodes in the symtable.
  * 
- *                As with the insertSymNode and deleteSymNode, the root is needed.
+ *            Order of the nodes is given by their position in the table.
  * 
- * @param rootPtr Pointer to the tree (subtree) for the node to be found.
- * @param key     Key of the node to be found.
+ * @param tb  Pointer to the symtable to iterate through.
+ * @param pos Pointer to the position of iteration, must be set to 0 before first call.
  * 
- * @return        If the node is found, the pointer to it. If the node does not exist, NULL.
+ * @return    Next node in the symtable, NULL when there are no more nodes.
  */
-symNode *findSymNode(symNode *rootPtr, char *key){
-    if(rootPtr == NULL){
-        return NULL;
-    }
-    else{
-        if(strcmp(key, rootPtr->key) != 0){
-            if(strcmp(key, rootPtr->key) < 0){
-                return(findSymNode(rootPtr->l, key));
-            }
-            else{
-                return(findSymNode(rootPtr->r, key));
-            }
-        }
-        else{
-            return rootPtr;
+symNode *nextSymNode(symtable *tb, int *pos){
+    while(*pos < tb->capacity){
+        symNode *node = tb->slots[(*pos)++].node;
+        if(node != NULL){
+            return node;
         }
     }
+    return NULL;
 }
 
 /**
- * @brief      Frees all nodes in the tree starting from the given node.
+ * @brief      Frees the node and data allocated for it.
  * 
- * @param node Pointer to the root of the subtree to be freed.
+ * @param node Pointer to the node to be freed.
  * 
- * @warning    Don't confuse it with deleteSymNode. This function does not rebalance the tree
- *             but frees all nodes in it. Should only be used when removing the tree.
+ * @warning    Don't confuse it with deleteSymNode. This function does not remove the node
+ *             from the table. Should only be used when removing the table.
  */
-void freeSymNodes(symNode *node){
+void freeSymNode(symNode *node){
     if(node == NULL){
         return;
     }
 
     if(node->data.varOrFun){
-        free(node->data.data.fData.paramTypes);
-        free(node->data.data.fData.paramNames);
-        free(node->data.data.fData.paramNullable);
+        freeFunData(node->data.data.fData);
     }
-    freeSymNodes(node->r);
-    freeSymNodes(node->l);
-    free(node);
+    poolFree(&nodePool, node);
+}
+
+/**
+ * @brief      Creates a copy of function data to be referenced from a symNode.
+ * 
+ * @param data Data describing the function.
+ * 
+ * @return     Pointer to the allocated function data.
+ */
+funData *createFunData(funData data){
+    funData *newData = (funData *)poolAlloc(&funPool);
+    *newData = data;
+    return newData;
+}
+
+/**
+ * @brief      Frees function data.
+ * 
+ * @param data Pointer to the function data to be freed.
+ */
+void freeFunData(funData *data){
+    if(data == NULL){
+        return;
+    }
+    poolFree(&funPool, data); // parameter arrays are in compileArena
+}
+
+/**
+ * @brief   Returns memory of all pools to the system.
+ * 
+ * @warning All symNodes and function data become invalid, use only at the end of the program.
+ */
+void releaseSymPools(){
+    poolRelease(&nodePool);
+    poolRelease(&funPool);
 }
 
 /**
- * @brief    Frees the symbol table and all its nodes.
+ * @brief    Frees all nodes of the symbol table and empties it.
+ * 
+ *           Memory of the table itself is released with compileArena.
  * 
  * @param tb Pointer to the symbol table to be deleted.
  */
@@ -265,10 +243,13 @@ void deleteSymtable(symtable *tb){
     if(tb == NULL){
         return;
     }
-    freeSymNodes(tb->rootPtr);
-    free(tb);
+    for(int i = 0; i < tb->capacity; i++){
+        freeSymNode(tb->slots[i].node);
+    }
+    initSymtable(tb); // table and slots are in compileArena
 }
 
+
 /**
  * @brief    Initializes the stack.
  * 
@@ -277,6 +258,7 @@ void deleteSymtable(symtable *tb){
 void initStack(stack *st){
     st->top     = NULL;
     st->elemCnt = 0;
+    initSymtable(&st->bindings);
 }
 
 /**
@@ -293,8 +275,11 @@ stackElem *createStElem(symtable *tb){
         ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
         return NULL;
     }
-    newElem->tbPtr = tb;
-    newElem->next  = NULL;
+    newElem->tbPtr   = tb;
+    newElem->next    = NULL;
+    newElem->undoLog = NULL;
+    newElem->undoCnt = 0;
+    newElem->undoCap = 0;
     return newElem;
 }
 
@@ -302,7 +287,8 @@ stackElem *createStElem(symtable *tb){
  * @brief    Pushes a symbol table onto the stack.
  * 
  *           Creates a new stack element containing the symbol table 
- *           and adds it to the top of the stack.
+ *           and adds it to the top of the stack. Symbols already present
+ *           in the table (eg. parameters of a function) become visible.
  * 
  * @param st Pointer to the stack.
  * @param tb Pointer to the symbol table to be pushed.
@@ -312,6 +298,12 @@ void push(stack *st, symtable *tb){
     newElem->next      = st->top;
     st->top            = newElem;
     st->elemCnt++;
+
+    int      pos  = 0;
+    symNode *node = NULL;
+    while((node = nextSymNode(tb, &pos)) != NULL){
+        bindSymNode(st, node);
+    }
 }
 
 /**
@@ -342,8 +334,14 @@ symtable *pop(stack *st){
 
     stackElem *tmp    = st->top;
     symtable  *tbPtr  = tmp->tbPtr;
+
+    for(int i = tmp->undoCnt - 1; i >= 0; i--){ // symbols of the scope are no longer visible
+        unbindSymNode(st, tmp->undoLog[i]);
+    }
+
     st->top           = tmp->next;
     st->elemCnt--;
+    free(tmp->undoLog);
     free(tmp);
 
     return tbPtr;
@@ -385,13 +383,14 @@ void freeStack(stack *st){
         symtable *tb = pop(st);
         deleteSymtable(tb);
     }
+    initSymtable(&st->bindings); // slots are in compileArena, nodes are owned by the scope tables
 }
 
 /**
  * @brief     Looks for an entry of a symbol with given key in the whole stack of symtables.
  * 
- *            Checks all of symtables in stack, until a node with the key is found 
- *            or until there are no more tables to check.
+ *            Stack keeps the innermost visible symbol for every key in one table of bindings,
+ *            so only one lookup is needed regardless of the number of scopes.
  * 
  * @param st  Pointer to the stack to search in.
  * @param key Key of the wanted symbol.
@@ -399,14 +398,88 @@ void freeStack(stack *st){
  * @return    Pointer to the symNode representing the symbol if found, NULL if not found in any of the parts of the stack. 
  */
 symNode *findInStack(stack *st, char *key){
-    symNode   *found = NULL;
-    stackElem *se    = st->top;
-    while(!isStackBottom(se) && found == NULL){
-        found = findSymNode(se->tbPtr->rootPtr, key);
-        se = se->next;
+    return findSymNode(&st->bindings, key);
+}
+
+/**
+ * @brief      Inserts a new symbol into the symtable on the top of the stack.
+ * 
+ *             Symbol becomes visible by findInStack, until the scope is popped.
+ * 
+ * @warning    Always use this function instead of insertSymNode on symtables in the stack.
+ * 
+ * @param st   Pointer to the stack.
+ * @param key  String key of a symbol to add.
+ * @param data Data for the new symbol to hold.
+ * 
+ * @return     Pointer to the inserted symNode.
+ */
+symNode *insertInStack(stack *st, char *key, symData data){
+    symtable *tb      = st->top->tbPtr;
+    bool      present = (findSymNode(tb, key) != NULL);
+    symNode  *node    = insertSymNode(tb, key, data);
+    if(!present){
+        bindSymNode(st, node);
     }
+    return node;
+}
 
-    return found;
+/**
+ * @brief      Takes a block from the pool.
+ * 
+ *             When there is no free block, new slab of SYMPOOL_SLAB_BLOCKS blocks is allocated.
+ *             Blocks of a slab are aligned to the cache line.
+ * 
+ * @param pool Pointer to the pool.
+ * 
+ * @return     Pointer to the block.
+ */
+void *poolAlloc(symPool *pool){
+    if(pool->freeList == NULL){
+        symPoolSlab *slab = malloc(CACHE_LINE + pool->blockSize * SYMPOOL_SLAB_BLOCKS);
+        if(slab == NULL){
+            ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
+        }
+        slab->next  = pool->slabs;
+        pool->slabs = slab;
+
+        // first block starts on the first cache line boundary after the header of the slab
+        char *block = (char *)slab + sizeof(symPoolSlab);
+        block      += (CACHE_LINE - (size_t)block % CACHE_LINE) % CACHE_LINE;
+        for(int i = 0; i < SYMPOOL_SLAB_BLOCKS; i++, block += pool->blockSize){
+            *(void **)block = pool->freeList;
+            pool->freeList  = block;
+        }
+    }
+
+    void *block    = pool->freeList;
+    pool->freeList = *(void **)block;
+    return block;
+}
+
+/**
+ * @brief       Returns the block to the pool, so it can be reused.
+ * 
+ * @param pool  Pointer to the pool.
+ * @param block Pointer to the block taken from the same pool.
+ */
+void poolFree(symPool *pool, void *block){
+    *(void **)block = pool->freeList;
+    pool->freeList  = block;
+}
+
+/**
+ * @brief      Frees all slabs of the pool.
+ * 
+ * @param pool Pointer to the pool.
+ */
+void poolRelease(symPool *pool){
+    while(pool->slabs != NULL){
+        symPoolSlab *next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+    pool->freeList = NULL;
 }
 
 /************************************************************************************************************** 
@@ -416,135 +489,195 @@ symNode *findInStack(stack *st, char *key){
 *************************************************************************************************************/
 
 /**
- * @brief         Finds the leftenmost node in a subtree, the node with the smallest key.
+ * @brief     Computes hash of the key (32-bit FNV-1a).
  * 
- * @param rootPtr Pointer to the root of the subtree.
+ * @param key Key to compute the hash of.
  * 
- * @see           deleteSymNodeRec
- * 
- * @return        Leftenmost node.
+ * @return    Hash of the key.
  */
-symNode *minSymNode(symNode *rootPtr){
-    if(rootPtr->l == NULL){
-        return rootPtr;
-    }
-    else{
-        return(minSymNode(rootPtr->l));
+unsigned hashKey(char *key){
+    unsigned hash = 2166136261u;
+    for(unsigned char *c = (unsigned char *)key; *c != '\0'; c++){
+        hash ^= *c;
+        hash *= 16777619u;
     }
+    return hash;
 }
 
 /**
- * @brief      Performs right-rotation of the subtree from the node.
- * 
- *             Used for rebalancing the tree if the left side is heavier than the right.
- * 
- * @param node Pointer to the critical node around which the rotation is performed.
+ * @brief      Computes how far the entry is from its home slot.
  * 
- * @see        insertSymNode, symNodeDelete
+ * @param tb   Pointer to the symtable.
+ * @param hash Hash of the key of the entry.
+ * @param slot Slot the entry is stored in.
  * 
- * @return     Pointer to a new root of a rotated subtree.
+ * @return     Number of slots between the home slot and the slot of the entry.
  */
-symNode *rRotate(symNode *node){
-
-    symNode *x = node->l;
-    node->l    = x->r;
-    x->r       = node;
-
-    node->height = max(heightVal(node->l), heightVal(node->r)) + 1;
-    x->height    = max(heightVal(x->l), heightVal(x->r)) + 1;
-    
-    return x;
+unsigned probeDist(symtable *tb, unsigned hash, int slot){
+    unsigned mask = tb->capacity - 1;
+    return ((unsigned)slot - (hash & mask)) & mask;
 }
 
 /**
- * @brief      Performs left-rotation of the subtree from the node.
+ * @brief      Looks for a slot holding the entry with given key.
  * 
- *             Used for rebalancing the tree if the righht side is heavier than the right.
+ *             Probing stops at an empty slot or at an entry that is closer to its home
+ *             slot than the searched key would be, as Robin Hood insertion would have
+ *             placed the key there.
  * 
- * @param node Pointer to the critical node around which the rotation is performed.
+ * @param tb   Pointer to the symtable.
+ * @param key  Key of the wanted entry.
+ * @param hash Hash of the key.
  * 
- * @see        insertSymNode, symNodeDelete
- * 
- * @return     Pointer to a new root of a rotated subtree.
+ * @return     Index of the slot if found, -1 otherwise.
  */
-symNode *lRotate(symNode *node){
-    
-    symNode *x = node->r; 
-    node->r    = x->l;     
-    x->l       = node;
-
-    node->height = max(heightVal(node->l), heightVal(node->r)) + 1;
-    x->height    = max(heightVal(x->l), heightVal(x->r)) + 1;
+int findSlot(symtable *tb, char *key, unsigned hash){
+    if(tb == NULL || tb->nodeCnt == 0){
+        return -1;
+    }
 
-    return x;
+    unsigned mask = tb->capacity - 1;
+    int      slot = hash & mask;
+    for(unsigned dist = 0; tb->slots[slot].node != NULL; dist++){
+        if(probeDist(tb, tb->slots[slot].hash, slot) < dist){
+            return -1;
+        }
+        if(tb->slots[slot].hash == hash && strcmp(tb->slots[slot].node->key, key) == 0){
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
 }
 
 /**
- * @brief      Gets the height of a node.
- * 
- *             Height is the maximum number of edges from the node to any of leaf nodes in its subtree.
+ * @brief      Places a node into a free slot using Robin Hood strategy.
  * 
- * @see        balanceVal
+ *             When the probed entry is closer to its home slot than the carried one,
+ *             they swap and the displaced entry continues probing.
  * 
- * @param node Pointer to a node we want height of.
+ * @warning    There must be at least one free slot in the table, no duplicity check is performed.
  * 
- * @return     Height of the node or 0 if node does not exist.
+ * @param tb   Pointer to the symtable.
+ * @param node Pointer to the node to place.
  */
-int heightVal(symNode *node){
-    if(node == NULL){
-        return 0;
+void placeSymNode(symtable *tb, symNode *node){
+    unsigned mask  = tb->capacity - 1;
+    symSlot  carry = {.hash = node->hash, .node = node};
+    int      slot  = carry.hash & mask;
+    unsigned dist  = 0;
+
+    while(tb->slots[slot].node != NULL){
+        unsigned existing = probeDist(tb, tb->slots[slot].hash, slot);
+        if(existing < dist){
+            symSlot tmp      = tb->slots[slot];
+            tb->slots[slot]  = carry;
+            carry            = tmp;
+            dist             = existing;
+        }
+        slot = (slot + 1) & mask;
+        dist++;
     }
-    return(node->height);
+    tb->slots[slot] = carry;
 }
 
 /**
- * @brief      Calculates the balance of a node.
- * 
- *             Balance is the difference between the height of the right and the left node.
- *             If its negative, the node is heavier on the left, if positive, on the right and if 0 it is balanced.
- *             In AVL height-balanced trees, the height of each node should be <-1,1>. If it is out of these bounds, 
- *             rotation is required.
+ * @brief      Empties the slot and shifts following entries of the same probe sequence one slot back.
  * 
- * @param node Node to check the balance of.
+ * @warning    Node in the slot is not freed.
  * 
- * @return     Balance number based on the heights of the children.
+ * @param tb   Pointer to the symtable.
+ * @param slot Slot to empty.
  */
-int balanceVal(symNode *node){
-    return(heightVal(node->r) - heightVal(node->l));
+void removeSlot(symtable *tb, int slot){
+    tb->nodeCnt--;
+
+    unsigned mask = tb->capacity - 1;
+    int      next = (slot + 1) & mask;
+    while(tb->slots[next].node != NULL && probeDist(tb, tb->slots[next].hash, next) > 0){
+        tb->slots[slot] = tb->slots[next];
+        slot = next;
+        next = (next + 1) & mask;
+    }
+    tb->slots[slot].node = NULL;
 }
 
 /**
- * @brief      Rebalances the node according to AVL tree balancing rules
- * 
- *             This function firstly checks, whether the rotations for rebalancing are needed. If yes,
- *             it rotates the nodes according to 4 different scenarios: LL, LR, RR, RL.
+ * @brief      Makes the node the visible symbol for its key in the stack.
  * 
- * @param node Pointer to a node to be rebalanced.
+ *             Previously visible symbol with the same key is remembered in the shadow chain 
+ *             of the node and the node is logged in the scope on the top of the stack.
  * 
- * @return     New root after rebalancing.
+ * @param st   Pointer to the stack.
+ * @param node Pointer to the node to make visible.
  */
-symNode *rebalance(symNode *node){
-    int balance = balanceVal(node);
-    if(balance < -1){ // The node is left-heavy (out of <-1,1> bounds)
-        if(balanceVal(node->l) <= 0){ // Left child is left-heavy (or balanced after deletion) -> LL
-           return rRotate(node);
-        }
-        else if(balanceVal(node->l) > 0){ // Left child is right-heavy -> LR
-            node->l = lRotate(node->l);
-            return rRotate(node);
+void bindSymNode(stack *st, symNode *node){
+    stackElem *se = st->top;
+    if(se->undoCnt == se->undoCap){
+        int       newCap = (se->undoCap == 0) ? SYMTABLE_INIT_CAPACITY : se->undoCap * 2;
+        symNode **tmp    = realloc(se->undoLog, sizeof(symNode *) * newCap);
+        if(tmp == NULL){
+            ERROR(ERR_INTERNAL,"Error occured while allocating memory.");
         }
+        se->undoLog = tmp;
+        se->undoCap = newCap;
     }
-    else if(balance > 1){ // The node is right-heavy (out of <-1,1> bounds)
-        if(balanceVal(node->r) >= 0){ // Right child is right-heavy (or balanced after deletion) -> RR
-            return lRotate(node);
-        }
-        else if(balanceVal(node->r) < 0){ // Right child is right-heavy -> RL
-            node->r = rRotate(node->r);
-            return lRotate(node);
-        }
+    se->undoLog[se->undoCnt++] = node;
+
+    int slot = findSlot(&st->bindings, node->key, node->hash);
+    if(slot >= 0){
+        node->shadowed                  = st->bindings.slots[slot].node;
+        st->bindings.slots[slot].node   = node;
+        return;
+    }
+
+    node->shadowed = NULL;
+    if((st->bindings.nodeCnt + 1) * 4 > st->bindings.capacity * 3){
+        growSymtable(&st->bindings);
+    }
+    placeSymNode(&st->bindings, node);
+    st->bindings.nodeCnt++;
+}
+
+/**
+ * @brief      Hides the node, symbol shadowed by it becomes visible again.
+ * 
+ * @param st   Pointer to the stack.
+ * @param node Pointer to the node to hide.
+ */
+void unbindSymNode(stack *st, symNode *node){
+    int slot = findSlot(&st->bindings, node->key, node->hash);
+    if(slot < 0 || st->bindings.slots[slot].node != node){
+        return;
+    }
+
+    if(node->shadowed != NULL){
+        st->bindings.slots[slot].node = node->shadowed;
+    }
+    else{
+        removeSlot(&st->bindings, slot);
     }
+    node->shadowed = NULL;
+}
+
+/**
+ * @brief    Doubles the number of slots and places all nodes again.
+ * 
+ * @param tb Pointer to the symtable to grow.
+ */
+void growSymtable(symtable *tb){
+    symSlot *oldSlots    = tb->slots;
+    int      oldCapacity = tb->capacity;
 
-    return node; // The node is balanced
+    tb->capacity = (oldCapacity == 0) ? SYMTABLE_INIT_CAPACITY : oldCapacity * 2;
+    tb->slots    = (symSlot *)arenaAlloc(&compileArena, sizeof(symSlot) * tb->capacity); // old slots stay in arena
+    memset(tb->slots, 0, sizeof(symSlot) * tb->capacity);
+
+    for(int i = 0; i < oldCapacity; i++){
+        if(oldSlots[i].node != NULL){
+            placeSymNode(tb, oldSlots[i].node);
+        }
+    }
 }
 
 /**
@@ -562,167 +695,71 @@ bool isStackBottom(stackElem *se){
 }
 
 
-int max(int a, int b){
-    return(a > b) ? a : b;
-}
-
-
 /**************************************************************************************************************
                                          SECTION Builtin
  **************************************************************************************************************/
 
-void prepareBuiltinSymtable(){
-    builtinSymtable = createSymtable();
-
-    symData data = {.varOrFun = 1};
-    funData fData = {.defined = true, 
-                     .paramTypes = NULL, 
-                     .paramNames = NULL};
-
-    // ifj.readstr() ?[]u8
-    fData.paramNum      = 0;
-    fData.returnType    = u8;
-    fData.nullableRType = true;
-    fData.paramTypes    = NULL;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "readstr", data);
-
-    // ifj.readi32() ?i32
-    fData.paramNum      = 0;
-    fData.returnType    = i32;
-    fData.nullableRType = true;
-    fData.paramTypes    = NULL;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "readi32", data);
-
-    // ifj.readf64() ?f64
-    fData.paramNum      = 0;
-    fData.returnType    = f64;
-    fData.nullableRType = true;
-    fData.paramTypes    = NULL;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "readf64", data);
-
-    // ifj.write(term) void
-    fData.paramNum         = 1;
-    fData.paramTypes       = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0]    = any;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 1;
-    fData.returnType       = void_;
-    data.data.fData        = fData;
-    insertSymNode(builtinSymtable, "write", data);
-
-    // ifj.i2f(term ∶ i32) f64
-    fData.paramNum      = 1;
-    fData.returnType    = f64;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = i32;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "i2f", data);
-
-    // ifj.f2i(term ∶ f64) i32
-    fData.paramNum      = 1;
-    fData.returnType    = i32;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = f64;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "f2i", data);
-
-    // ifj.string(term) []u8
-    fData.paramNum      = 1;
-    fData.returnType    = u8;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = stringOru8;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "string", data);
-
-    // ifj.length(s : []u8) i32
-    fData.paramNum      = 1;
-    fData.returnType    = i32;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = u8;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "length", data);
-
-    // ifj.concat(s1 : []u8, s2 : []u8) []u8
-    fData.paramNum      = 2;
-    fData.returnType    = u8;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = u8;
-    fData.paramTypes[1] = u8;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    fData.paramNullable[1] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "concat", data);
-
-    // ifj.substring(s : []u8, i : i32, j : i32) ?[]u8
-    fData.paramNum      = 3;
-    fData.returnType    = u8;
-    fData.nullableRType = true;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = u8;
-    fData.paramTypes[1] = i32;
-    fData.paramTypes[2] = i32;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    fData.paramNullable[1] = 0;
-    fData.paramNullable[2] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "substring", data);
-    
-    //  ifj.strcmp(s1 : []u8, s2 : []u8) i32
-    fData.paramNum      = 2;
-    fData.returnType    = i32;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = u8;
-    fData.paramTypes[1] = u8;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    fData.paramNullable[1] = 0;
-    data.data.fData     = fData;
-
-    insertSymNode(builtinSymtable, "strcmp", data);
-    
-    // ifj.ord(s : []u8, i : i32) i32
-    fData.paramNum      = 2;
-    fData.returnType    = i32;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = u8;
-    fData.paramTypes[1] = i32;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    fData.paramNullable[1] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "ord", data);
-    
-    // ifj.chr(i : i32) []u8 
-    fData.paramNum      = 1;
-    fData.returnType    = u8;
-    fData.nullableRType = false;
-    fData.paramTypes    = malloc(sizeof(dataType) * fData.paramNum);
-    fData.paramTypes[0] = i32;
-    fData.paramNullable    = malloc(sizeof(bool) * fData.paramNum);
-    fData.paramNullable[0] = 0;
-    data.data.fData     = fData;
-    insertSymNode(builtinSymtable, "chr", data);
-    
+/* Builtin function of ifj namespace as a read-only symNode, parameter arrays and data are const objects
+   with static storage, casts only fit them to pointers of symData, nothing writes through them */
+#define BUILTIN(id, retType, nullableRet, num, types, nullables)                                        \
+    {.key  = id,                                                                                        \
+     .data = {.varOrFun   = 1,                                                                          \
+              .used       = true,                                                                       \
+              .data.fData = (funData *)&(const funData){.defined       = true,                         \
+                                                        .returnType    = retType,                       \
+                                                        .nullableRType = nullableRet,                   \
+                                                        .paramTypes    = (dataType *)types,             \
+                                                        .paramNullable = (bool *)nullables,             \
+                                                        .paramNum      = num}}}
+
+/* table of builtin functions, sorted by key for binary search, never modified (shared by all threads) */
+static const symNode builtinTable[] = {
+    BUILTIN("chr",       u8,    false, 1, (const dataType[]){i32},          (const bool[]){0}),       // ifj.chr(i : i32) []u8
+    BUILTIN("concat",    u8,    false, 2, ((const dataType[]){u8, u8}),     ((const bool[]){0, 0})),  // ifj.concat(s1 : []u8, s2 : []u8) []u8
+    BUILTIN("f2i",       i32,   false, 1, (const dataType[]){f64},          (const bool[]){0}),       // ifj.f2i(f : f64) i32
+    BUILTIN("i2f",       f64,   false, 1, (const dataType[]){i32},          (const bool[]){0}),       // ifj.i2f(i : i32) f64
+    BUILTIN("length",    i32,   false, 1, (const dataType[]){u8},           (const bool[]){0}),       // ifj.length(s : []u8) i32
+    BUILTIN("ord",       i32,   false, 2, ((const dataType[]){u8, i32}),    ((const bool[]){0, 0})),  // ifj.ord(s : []u8, i : i32) i32
+    BUILTIN("readf64",   f64,   true,  0, NULL,                             NULL),                    // ifj.readf64() ?f64
+    BUILTIN("readi32",   i32,   true,  0, NULL,                             NULL),                    // ifj.readi32() ?i32
+    BUILTIN("readstr",   u8,    true,  0, NULL,                             NULL),                    // ifj.readstr() ?[]u8
+    BUILTIN("strcmp",    i32,   false, 2, ((const dataType[]){u8, u8}),     ((const bool[]){0, 0})),  // ifj.strcmp(s1 : []u8, s2 : []u8) i32
+    BUILTIN("string",    u8,    false, 1, (const dataType[]){stringOru8},   (const bool[]){0}),       // ifj.string(term) []u8
+    BUILTIN("substring", u8,    true,  3, ((const dataType[]){u8, i32, i32}), ((const bool[]){0, 0, 0})), // ifj.substring(s : []u8, i : i32, j : i32) ?[]u8
+    BUILTIN("write",     void_, false, 1, (const dataType[]){any},          (const bool[]){1}),       // ifj.write(term) void
+};
+
+#define BUILTIN_CNT ((int)(sizeof(builtinTable) / sizeof(builtinTable[0])))
+
+/**
+ * @brief    Finds a builtin function of ifj namespace.
+ * 
+ *           Static table of builtins is searched by binary search, nothing is
+ *           allocated and the table needs no initialisation.
+ * 
+ * @warning  Returned node is shared by all threads and read-only.
+ * 
+ * @param id Id of the builtin function (without "ifj.").
+ * 
+ * @return   Pointer to the symNode of the builtin function, NULL if there is no such builtin.
+ */
+const symNode *findBuiltin(char *id){
+    int low  = 0;
+    int high = BUILTIN_CNT - 1;
+    while(low <= high){
+        int mid = (low + high) / 2;
+        int cmp = strcmp(id, builtinTable[mid].key);
+        if(cmp == 0){
+            return &builtinTable[mid];
+        }
+        if(cmp < 0){
+            high = mid - 1;
+        }
+        else{
+            low = mid + 1;
+        }
+    }
+    return NULL;
 }
 
 
@@ -738,6 +775,8 @@ void prepareBuiltinSymtable(){
 /**
  * @brief      Prints .dot representation of symtable
  * 
+ *             Every entry is printed with its slot and distance from its home slot,
+ *             entries in the same cluster of occupied slots are connected by an edge.
  *             Copy the printed representation to https://dreampuf.github.io/GraphvizOnline and see.
  *             Recommended output file is stdout.
  * 
@@ -749,7 +788,9 @@ void printSymtable(FILE *file, symtable *tb){
         return;
     }
     fprintf(file, "digraph G{\n");
-    printNode(file, tb->rootPtr);
+    for(int slot = 0; slot < tb->capacity; slot++){
+        printNode(file, tb, slot);
+    }
     fprintf(file, "}\n");
 
 }
@@ -758,25 +799,24 @@ void printSymtable(FILE *file, symtable *tb){
  * @brief       Function for printing .dot of individual nodes.
  * 
  * @param file  Output file.
- * @param node  Pointer to node to be printed out.
+ * @param tb    Pointer to symtable the node is in.
+ * @param slot  Slot of the node to be printed out.
  */
-void printNode(FILE *file, symNode *node){
+void printNode(FILE *file, symtable *tb, int slot){
+    symNode *node = tb->slots[slot].node;
     if(node == NULL)
     {
         return;
     }
 
     fprintf(file, "%s [label=\"ID: %s\n", node->key, node->key);
+    fprintf(file, "slot: %d probe: %u", slot, probeDist(tb, tb->slots[slot].hash, slot));
 
     fprintf(file, "\"];\n");
 
-    if(node->l != NULL){
-        fprintf(file, "%s -> %s [style=dashed];\n", node->key, node->l->key);
-        printNode(file, node->l);
-    }
-    if(node->r != NULL){
-        fprintf(file, "%s -> %s;\n", node->key, node->r->key);
-        printNode(file, node->r);
+    symNode *next = tb->slots[(slot + 1) & (tb->capacity - 1)].node;
+    if(next != NULL && next != node){
+        fprintf(file, "%s -> %s [style=dashed];\n", node->key, next->key);
     }
 }
 
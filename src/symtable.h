@@ -6,11 +6,12 @@
  * @brief  Header file for a table of symbols for a compiler.
  * 
  *         File contains function declarations for working with symtable, implemented as a 
- *         AVL-balanced binary search tree (vv-BVS), such as insertion, deletion, search. It also includes 
- *         data structs used in the implementation.
+ *         hash table with open addressing (Robin Hood hashing), such as insertion, deletion, search. 
+ *         It also includes data structs used in the implementation.
  *         Another part is the stack of symtables, which represents different scopes in code. Basic operations as
  *         init, pop, push are present, but also a very important function findInStack (for more information check
- *         function documentation in symtable.c).
+ *         function documentation in symtable.c). Stack keeps a single table of currently visible symbols 
+ *         (LeBlanc-Cook style), so findInStack does not depend on the depth of nesting.
  *         Includes also functions for printing out .dot representation of symtable.
  * 
  * @author xnovakf00 Filip Novák
@@ -49,6 +50,7 @@ typedef struct funData{
    bool     *paramNullable;
    char    **paramNames;
    int       paramNum;
+   int       frameSize;  // number of variable slots in the frame of the function (parameters included)
    symtable *tbPtr;
 }funData;
 
@@ -58,13 +60,14 @@ typedef struct varData{
    bool isNullable; // 1 if nullable 0 if not
    bool inheritedType; // 1 if needs to be inherited from expression, 0 if set
    bool knownDuringCompile; // 1 if value is known during compile time, 0 if not
+   bool nullValue; // if it holds null
+   int  slot; // index of the variable in the frame of its function, shared by variables with the same name
   
    union{
       double floatData;
       int    intData;
       char  *charData;
    }value; // value in case it is known during compile time, used in expression parsing
-    bool nullValue; // if it holds null
 }varData;
 
  typedef struct symData{
@@ -74,52 +77,68 @@ typedef struct varData{
     bool changed;
 
     union{
-      funData fData;
-      varData vData;
+      funData *fData; // cold data of functions are kept out of the node, see createFunData()
+      varData  vData;
     }data;
 
  }symData;
  
  typedef struct symNode{
-    char *key;
-    int height; // the maximum number of edges from the node to any of the leaves in its subtree
+    char    *key;
+    unsigned hash; // cached hash of the key
 
     symData data;
 
-    struct symNode *r; // pointer to the right node (with greater key)
-    struct symNode *l; // pointer to the left node (with lower key)
- }symNode; // structure representing the entry in the table of symbols (node of a tree)
+    struct symNode *shadowed; // symbol with the same key in an outer scope, hidden by this one (only when in stack)
+
+ }symNode; // structure representing the entry in the table of symbols
  
+/* Fixed-size block allocator for symNodes and funData, blocks are carved from slabs
+   and recycled through a free list */
+ typedef struct symPoolSlab{
+    struct symPoolSlab *next;
+ }symPoolSlab;
+
+ typedef struct symPool{
+    size_t       blockSize;
+    void        *freeList;  // freed blocks, first bytes of a free block point to the next one
+    symPoolSlab *slabs;
+ }symPool;
+
+ typedef struct symSlot{
+    unsigned hash; // copy of the hash of the key, so probing does not have to touch the node
+    symNode *node; // NULL if the slot is empty
+ }symSlot;
+
  struct symtable{
-    symNode *rootPtr;
+    symSlot *slots;    // allocated on first insertion, so empty scopes cost no extra allocation
+    int      capacity; // number of slots, always power of 2 (or 0 when slots are not allocated)
     int      nodeCnt;
  };
 
 typedef struct stackElem{
    symtable         *tbPtr;
    struct stackElem *next;
+   symNode         **undoLog; // symbols bound when entering/in this scope, unbound in reverse order on pop
+   int               undoCnt;
+   int               undoCap;
 }stackElem;
 
 typedef struct stack{
    stackElem *top;
    int       elemCnt;
+   symtable  bindings; // innermost visible symNode for every key in the stack, does not own the nodes
 }stack;
 
 /* global variable, must be initialised in exactly one .c file, 
    accessed anywhere where symtable.h is included */
-extern stack symtableStack; 
+extern THREAD_LOCAL stack symtableStack; 
 
 /* global variable of symtable for functions, 
    function createSymtable() should be called on it
    in exactly one file, accessible everywhere where
    symtable.h is included */
-extern symtable* funSymtable;
-
-/* global variable of symtable for builtin functions, 
-   function prepareBuiltinSymtable() should be called on it
-   in exactly one file, accessible everywhere where
-   symtable.h is included */
-extern symtable* builtinSymtable;
+extern THREAD_LOCAL symtable* funSymtable;
                            
 
 /* Functions for working with symtable and stack of symtables (user) */
@@ -128,14 +147,15 @@ symtable*  createSymtable();
 void       initSymtable  (symtable *tb);
 void       deleteSymtable(symtable *tb);
 
-symNode*   createSymNode (char *key, symData data);
-void       insertSymNode (symtable *tb, char *key, symData data);
+symNode*   createSymNode (char *key, unsigned hash, symData data);
+symNode*   insertSymNode (symtable *tb, char *key, symData data);
 void       deleteSymNode (symtable *tb, char *key);
-
-symNode*   insertSymNodeRec (symNode *rootPtr, char *key, symData data, symtable *tb);
-symNode*   deleteSymNodeRec (symNode *rootPtr,  char *key, symtable *tb);
-symNode*   findSymNode      (symNode *rootPtr, char *key);
-void       freeSymNodes     (symNode *node);
+symNode*   findSymNode   (symtable *tb, char *key);
+symNode*   nextSymNode   (symtable *tb, int *pos);
+void       freeSymNode   (symNode *node);
+funData*   createFunData (funData data);
+void       freeFunData   (funData *data);
+void       releaseSymPools();
 
 void       initStack     (stack *st);
 void       push          (stack *st, symtable *tb);
@@ -147,23 +167,28 @@ void       freeStack     (stack *st);
 bool       isStackBottom (stackElem *se);
 
 symNode*   findInStack   (stack *st, char *key);
+symNode*   insertInStack (stack *st, char *key, symData data);
 
 
 /* Helper functions used in implementations of the above */
-symNode*   minSymNode    (symNode *rootPtr);
-symNode*   rRotate       (symNode *node);
-symNode*   lRotate       (symNode *node);
-symNode*   rebalance     (symNode *node);
-int        heightVal     (symNode *node);
-int        balanceVal    (symNode *node);
-int        max           (int a, int b);
+unsigned   hashKey       (char *key);
+int        findSlot      (symtable *tb, char *key, unsigned hash);
+void       placeSymNode  (symtable *tb, symNode *node);
+void       growSymtable  (symtable *tb);
+unsigned   probeDist     (symtable *tb, unsigned hash, int slot);
+void       removeSlot    (symtable *tb, int slot);
+void*      poolAlloc     (symPool *pool);
+void       poolFree      (symPool *pool, void *block);
+void       poolRelease   (symPool *pool);
+void       bindSymNode   (stack *st, symNode *node);
+void       unbindSymNode (stack *st, symNode *node);
 
 
-void prepareBuiltinSymtable();
+const symNode* findBuiltin(char *id);
 
 /* Functions for printing .dot file for debugging */
 void printSymtable(FILE *file, symtable *tb);
-void printNode(FILE *file, symNode *node);
+void printNode(FILE *file, symtable *tb, int slot);
 
 
 #endif //SYMTABLE_H
@@ -0,0 +1,26 @@
+/**
+ *         Implementation of IFJ24 imperative language compiler.
+ * 
+ * @file   thread_local.h
+ * 
+ * @brief  Storage class of global state of a compilation.
+ * 
+ *         Every thread has its own copy of variables marked THREAD_LOCAL, so threads
+ *         of batch mode can compile different programs at the same time.
+ *         Data which are only read (keywords, tables, code of builtin functions) stay shared.
+ * 
+ * @date   19.10.2026
+*/
+
+#ifndef THREAD_LOCAL_H
+#define THREAD_LOCAL_H
+
+#if defined(__GNUC__) // GCC and Clang
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
+#endif //THREAD_LOCAL_H
+
+/* EOF thread_local.h */